@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <ctjson/detail/Escape.hpp>
+#include <ctjson/detail/NumberFormat.hpp>
+#include <ctjson/detail/OutputBuffer.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Writer of json directly to contiguous buffer
+ *
+ * Has the same interface as SimpleWriter, but does not validate nesting:
+ * calls are expected to come from Serializer. Each value reserves space for
+ * its longest output once and is written through raw pointer.
+ *
+ * Floating point values are written in shortest form that reads back to the
+ * same value or with fixed precision, @see set_float_precision. NaN and
+ * infinity are written as null.
+ */
+class BufferWriter {
+public:
+  /**
+   * @param capacity initial capacity of buffer
+   */
+  explicit BufferWriter(const size_t capacity = 256) : m_buffer(capacity) {}
+
+  /**
+   * @brief Writer to fixed external storage
+   *
+   * @param data external storage, should outlive the writer
+   * @param capacity size of @ref data, output past it is discarded,
+   * @see overflowed
+   */
+  BufferWriter(char *data, const size_t capacity) : m_buffer(data, capacity) {}
+
+  /**
+   * @return true if complete json value is written
+   */
+  bool is_complete() const { return m_depth == 0 && m_has_value; }
+
+  void null() {
+    value_prefix();
+    m_buffer.append("null");
+  }
+
+  void boolean(bool value) {
+    value_prefix();
+    m_buffer.append(value ? std::string_view("true")
+                          : std::string_view("false"));
+  }
+
+  template <typename Int>
+  void integer(Int value) {
+    value_prefix();
+    write_number<detail::max_integer_size<Int>()>(
+        [value](char *out) { return detail::write_integer(out, value); });
+  }
+
+  template <typename Floating>
+  void floating(Floating value) {
+    if (!std::isfinite(value)) {
+      null();
+      return;
+    }
+
+    value_prefix();
+    write_number<detail::max_floating_size<Floating>()>(
+        [value, format = m_float_format](char *out) {
+          return detail::write_floating(out, value, format);
+        });
+  }
+
+  void string(std::string_view value) {
+    value_prefix();
+    detail::write_string(m_buffer, value, m_validate_utf8);
+  }
+
+  void start_object() { start('{'); }
+
+  void key(std::string_view key) {
+    value_prefix();
+    detail::write_string(m_buffer, key, m_validate_utf8);
+    m_buffer.put(':');
+    m_need_comma = false;
+  }
+
+  /**
+   * @brief Write pre-rendered key: optional comma, quoted and escaped key and
+   * colon, @see detail::KeyFragments
+   *
+   * @param fragment key fragment, with comma unless key is first in object
+   */
+  void raw_key(std::string_view fragment) {
+    m_buffer.append(fragment);
+    m_need_comma = false;
+  }
+
+  void end_object() { end('}'); }
+
+  void start_array() { start('['); }
+
+  void end_array() { end(']'); }
+
+  /**
+   * @brief Set formatting of floating point values
+   *
+   * @param precision number of digits after decimal point in fixed notation,
+   * std::nullopt for shortest representation (default). Precision above
+   * detail::FloatFormat::max_precision (32) is clamped to it
+   */
+  void set_float_precision(const std::optional<unsigned> precision) {
+    m_float_format.precision =
+        precision ? std::min(static_cast<int>(*precision),
+                             detail::FloatFormat::max_precision)
+                  : detail::FloatFormat::shortest;
+  }
+
+  /**
+   * @brief Enable validation of UTF-8 in strings and keys, bytes of invalid
+   * sequences are replaced with U+FFFD then
+   *
+   * Disabled by default, so strings are written as is
+   */
+  void set_validate_utf8(const bool validate) { m_validate_utf8 = validate; }
+
+  /**
+   * @return true if json did not fit external storage
+   */
+  bool overflowed() const { return m_buffer.overflowed(); }
+
+  /**
+   * @return written json
+   */
+  std::string_view view() const { return m_buffer.view(); }
+
+  /**
+   * @return written json, writer is left empty
+   */
+  std::string release() {
+    m_depth = 0;
+    m_need_comma = false;
+    m_has_value = false;
+    return m_buffer.release();
+  }
+
+protected:
+  /**
+   * @brief Write comma before value if it is not first in container
+   */
+  void value_prefix() {
+    if (m_need_comma) {
+      m_buffer.put(',');
+    }
+    m_need_comma = true;
+    m_has_value = true;
+  }
+
+  detail::OutputBuffer m_buffer;
+
+private:
+  /**
+   * @brief Write number directly to buffer if there is space for longest
+   * output, through temporary buffer otherwise, so that exactly sized buffer
+   * is not grown
+   *
+   * @tparam max_size maximal size of number
+   * @param write callable writing number to pointer, returning its end
+   */
+  template <size_t max_size, typename Write>
+  void write_number(const Write &write) {
+    if (m_buffer.available() >= max_size) {
+      m_buffer.commit(write(m_buffer.reserve(max_size)));
+    } else {
+      char buffer[max_size];
+      m_buffer.append({buffer, static_cast<size_t>(write(buffer) - buffer)});
+    }
+  }
+
+  void start(const char bracket) {
+    value_prefix();
+    m_buffer.put(bracket);
+    m_need_comma = false;
+    ++m_depth;
+  }
+
+  void end(const char bracket) {
+    m_buffer.put(bracket);
+    m_need_comma = true;
+    --m_depth;
+  }
+
+  detail::FloatFormat m_float_format;
+  bool m_validate_utf8 = false;
+  size_t m_depth = 0;
+  // Previous value is written in current container
+  bool m_need_comma = false;
+  // Any value is written
+  bool m_has_value = false;
+};
+
+} // namespace ctjson
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 
 #include <ctjson/Deserializer.hpp>
+#include <ctjson/FieldNames.hpp>
 #include <ctjson/ParseResult.hpp>
 
 #include <ctjson/detail/Field.hpp>
+#include <ctjson/detail/KeyIndex.hpp>
 #include <ctjson/detail/Token.hpp>
 #include <ctjson/detail/TypeUtils.hpp>
 #include <ctjson/detail/Typing.hpp>
@@ -41,6 +46,14 @@ namespace ctjson {
  */
 class DeserializationHelper {
 public:
+  /**
+   * @brief Handling of keys which are not fields of class
+   */
+  enum class UnknownKeys {
+    Error, // Fail with "Unexpected key" error
+    Skip,  // Skip value without parsing
+  };
+
   /**
    * @brief Class representing class field
    *
@@ -77,6 +90,26 @@ public:
       m_set = true;
     }
 
+    /**
+     * @return reference to field value to parse into
+     * @post field is set
+     */
+    T &set_in_place() {
+      m_set = true;
+      return Base::m_ref;
+    }
+
+    /**
+     * @brief Reset optional field which was not set
+     */
+    void reset_if_unset() {
+      if constexpr (Base::is_opt) {
+        if (!m_set) {
+          Base::m_ref.reset();
+        }
+      }
+    }
+
   private:
     bool m_set;
   };
@@ -84,91 +117,132 @@ public:
   /**
    * @brief Parse class with given @param fields
    *
+   * Fields are parsed in place, reusing their capacity, and optional fields
+   * missing in json are reset, so this could be used in json_parse_into
+   *
+   * @tparam unknown_keys handling of unknown keys
    * @tparam Tokens type of token stream
    * @tparam Args types of fields
    * @param tokens token stream
    * @param fields references to fields
    * @return empty result if parsing was successful, error result otherwise
    */
-  template <typename Tokens, typename... Args>
+  template <UnknownKeys unknown_keys = UnknownKeys::Error, typename Tokens,
+            typename... Args>
   static inline ParseResult<void> parse_object(Tokens &tokens,
                                                Field<Args> &...fields) {
-    const auto maybeToken = tokens.next();
-    if (!maybeToken) {
-      if (tokens.has_error()) {
-        return ParseResult<void>::json_error(tokens.get_error(),
-                                             tokens.get_path());
-      } else {
-        // TODO: Provide better error
-        return ParseResult<void>::parse_error(
-            Deserializer::unexpected_end_error(), tokens.get_path());
-      }
-    }
-
-    const auto &token = maybeToken.value();
-    if (!token.template is_of_type<detail::Token::Type::StartObject>()) {
-      // TODO: Provide better error
-      return ParseResult<void>::parse_error(
-          Deserializer::unexpected_token_error<
-              detail::Token::Type::StartObject>(token),
-          tokens.get_path());
-    }
+    return parse_members(
+        tokens,
+        [&](const std::string_view key) {
+          const auto index = find_field(key, fields...);
+          if (index == sizeof...(Args)) {
+            return unknown_key<unknown_keys>(tokens, key);
+          }
 
-    const auto map = build_fields_map(fields...);
+          return parse_field(tokens, index, fields...);
+        },
+        [&]() {
+          /**
+           * In case `Args = {}`, all fields are always ready
+           * We need this if just to not compile `missing_keys_error`
+           */
+          if constexpr (sizeof...(Args) > 0) {
+            // All field are set or optional
+            if (!(fields.is_ready() && ...)) {
+              return Deserializer::parse_error_at(
+                  missing_keys_error(
+                      std::array<bool, sizeof...(Args)>{fields.is_ready()...},
+                      std::array<std::string_view, sizeof...(Args)>{
+                          fields.name...}),
+                  tokens);
+            }
 
-    while (true) {
-      const auto &maybeToken = tokens.next();
-      if (!maybeToken) {
-        if (tokens.has_error()) {
-          return ParseResult<void>::json_error(tokens.get_error(),
-                                               tokens.get_path());
-        } else {
-          // TODO: Provide better error
-          return ParseResult<void>::parse_error(
-              Deserializer::unexpected_end_error(), tokens.get_path());
-        }
-      }
+            (fields.reset_if_unset(), ...);
+          }
 
-      const auto &token = maybeToken.value();
-      if (token.template is_of_type<detail::Token::Type::EndObject>()) {
-        // All field are set or optional
-        if ((fields.is_ready() && ... && true)) {
           return ParseResult<void>::result();
-        }
+        });
+  }
 
-        /**
-         * In case `Args = {}`, condition above would always be true
-         * We need this if just to not compile `missing_keys_error`
-         */
-        if constexpr (sizeof...(Args) > 0) {
-          // TODO: Provide better error
-          return ParseResult<void>::parse_error(missing_keys_error(fields...),
-                                                tokens.get_path());
-        }
-      }
+  /**
+   * @brief Parse class with compile-time field names
+   *
+   * Keys are looked up with compile-time perfect hash, without allocation.
+   * Fields are parsed in place, reusing their capacity, and optional fields
+   * missing in json are reset. So the same call implements in-place parsing:
+   * @code{.cpp}
+   *   template<typename Tokens>
+   *   static ParseResult<void> json_parse_into(ParseClass &object,
+   *                                            Tokens &tokens) {
+   *       return DeserializationHelper::parse_object<json_names>(
+   *           tokens, object.str, object.integer);
+   *   }
+   * @endcode
+   *
+   * Usage example:
+   * @code{.cpp}
+   * struct ParseClass {
+   *   std::string str;
+   *   int integer;
+   *
+   *   constexpr static auto json_names = field_names("str", "integer");
+   *
+   *   template<typename Tokens>
+   *   static ParseResult<ParseClass> json_parse(Tokens &tokens) {
+   *       ParseClass object;
+   *       auto result = DeserializationHelper::parse_object<json_names>(
+   *           tokens, object.str, object.integer);
+   *       ...
+   *   }
+   * };
+   * @endcode
+   *
+   * @tparam names reference to constexpr field names, @see field_names
+   * @tparam unknown_keys handling of unknown keys
+   * @tparam Tokens type of token stream
+   * @tparam Args types of fields
+   * @param tokens token stream
+   * @param refs references to fields, in order of @ref names
+   * @return empty result if parsing was successful, error result otherwise
+   */
+  template <const auto &names, UnknownKeys unknown_keys = UnknownKeys::Error,
+            typename Tokens, typename... Args>
+  static inline ParseResult<void> parse_object(Tokens &tokens, Args &...refs) {
+    using Index = detail::KeyIndex<names>;
+    static_assert(Index::size == sizeof...(Args),
+                  "Number of names and fields should be equal");
 
-      if (!token.template is_of_type<detail::Token::Type::Key>()) {
-        // TODO: Provide better error
-        return ParseResult<void>::parse_error(
-            Deserializer::unexpected_token_error<
-                detail::Token::Type::Key, detail::Token::Type::EndObject>(
-                token),
-            tokens.get_path());
-      }
+    std::array<bool, sizeof...(Args)> set = {};
 
-      const auto key =
-          std::move(token.template value<detail::Token::Type::Key>());
-      if (map.count(key) == 0) {
-        return ParseResult<void>::parse_error("Unexpected key: " + key,
-                                              tokens.get_path());
-      }
+    return parse_members(
+        tokens,
+        [&](const std::string_view key) {
+          const auto index = Index::find(key);
+          if (index == sizeof...(Args)) {
+            return unknown_key<unknown_keys>(tokens, key);
+          }
 
-      const auto index = map.at(key);
-      auto field_result = parse_field(tokens, key, index, fields...);
-      if (!field_result.is_ok()) {
-        return field_result;
-      }
-    }
+          if (set[index]) {
+            // Key equals name, which has static storage
+            return Deserializer::parse_error_at(
+                {.code = ErrorCode::DuplicateKey, .text = names[index]},
+                tokens);
+          }
+
+          set[index] = true;
+          return parse_ref(tokens, index, refs...);
+        },
+        [&]() {
+          if (!all_ready<Args...>(set)) {
+            // TODO: Provide better error
+            return Deserializer::parse_error_at(
+                missing_names_error<names, Args...>(set), tokens);
+          }
+
+          reset_unset<Args...>(set, refs...);
+
+          return ParseResult<void>::result();
+        });
   }
 
   /**
@@ -203,26 +277,113 @@ public:
 
 private:
   /**
+   * @brief Parse json object, delegating members to callbacks
+   *
+   * @tparam Tokens type of token stream
+   * @tparam OnKey type of key callback
+   * @tparam OnEnd type of end callback
+   * @param tokens token stream
+   * @param on_key called with each key, should parse member value
+   * @param on_end called on end of object, should check that all
+   * required members were parsed
+   * @return empty result if parsing was successful, error result otherwise
+   */
+  template <typename Tokens, typename OnKey, typename OnEnd>
+  static inline ParseResult<void> parse_members(Tokens &tokens, OnKey on_key,
+                                                OnEnd on_end) {
+    const auto maybeToken = tokens.next();
+    if (!maybeToken) {
+      return Deserializer::no_token_error(tokens);
+    }
+
+    const auto &token = maybeToken.value();
+    if (!token.template is_of_type<detail::Token::Type::StartObject>()) {
+      // TODO: Provide better error
+      return Deserializer::parse_error_at(
+          Deserializer::unexpected_token_error<
+              detail::Token::Type::StartObject>(token),
+          tokens);
+    }
+
+    while (true) {
+      const auto &maybeToken = tokens.next();
+      if (!maybeToken) {
+        return Deserializer::no_token_error(tokens);
+      }
+
+      const auto &token = maybeToken.value();
+      if (token.template is_of_type<detail::Token::Type::EndObject>()) {
+        return on_end();
+      }
+
+      if (!token.template is_of_type<detail::Token::Type::Key>()) {
+        // TODO: Provide better error
+        return Deserializer::parse_error_at(
+            Deserializer::unexpected_token_error<
+                detail::Token::Type::Key, detail::Token::Type::EndObject>(
+                token),
+            tokens);
+      }
+
+      // Key is valid until next iteration, token is kept alive
+      const std::string_view key =
+          token.template value<detail::Token::Type::Key>();
+      auto member_result = on_key(key);
+      if (!member_result.is_ok()) {
+        return member_result;
+      }
+    }
+  }
+
+  /**
+   * @brief Handle key which is not a field
+   *
+   * @tparam unknown_keys handling of unknown keys
+   * @tparam Tokens type of token stream
+   * @param tokens token stream
+   * @param key unknown json key
+   * @return empty result if value was skipped, error result otherwise
+   */
+  template <UnknownKeys unknown_keys, typename Tokens>
+  static ParseResult<void> unknown_key(Tokens &tokens,
+                                       const std::string_view key) {
+    if constexpr (unknown_keys == UnknownKeys::Skip) {
+      if (tokens.skip_value()) {
+        return ParseResult<void>::result();
+      }
+
+      return Deserializer::no_token_error(tokens);
+    } else {
+      // Key is not static, it is copied
+      ParseResult<void>::Error error = {.code = ErrorCode::UnexpectedKey};
+      error.set_text(std::string(key));
+
+      return Deserializer::parse_error_at(std::move(error), tokens);
+    }
+  }
+
+  /**
+   * @brief Find field by key without allocating
+   *
    * @tparam Args types of fields
+   * @param key json key
    * @param fields references to fields
-   * @return map (field name -> field 0-based index in fields)
+   * @return 0-based index of field with name @ref key in fields
+   * or sizeof...(Args) if there is no such field
    */
   template <typename... Args>
-  static std::unordered_map<std::string, size_t>
-  build_fields_map(const Field<Args> &...fields) {
-    std::unordered_map<std::string, size_t> result;
-    size_t counter = 0;
-
-    ([&]() { result[fields.name] = counter++; }(), ...);
+  static size_t find_field(const std::string_view key,
+                           const Field<Args> &...fields) {
+    size_t index = 0;
+    ((std::string_view(fields.name) == key || (++index, false)) || ...);
 
-    return result;
+    return index;
   }
 
   /**
    * @tparam Tokens token stream type
    * @tparam Args fields types
    * @param tokens token stream
-   * @param key json key for this field
    * @param index 0-based index of field in fields
    * @param fields references to fields
    * @return successful result without value or error
@@ -230,43 +391,141 @@ private:
    */
   template <typename Tokens, typename... Args>
   static ParseResult<void>
-  parse_field(Tokens &tokens,
-              const std::string key, // Just for error message
-              const size_t index, Field<Args> &...fields) {
-    std::optional<ParseResult<void>> result = std::nullopt;
+  parse_field(Tokens &tokens, const size_t index, Field<Args> &...fields) {
+    auto result = ParseResult<void>::result();
 
     detail::call_on_nth(
         index,
         [&](auto &field) {
-          using FieldType = typename std::decay_t<decltype(field)>::type;
-
           if (field.is_set()) {
-            result.emplace(ParseResult<void>::parse_error(
-                "Duplicate key: " + key, tokens.get_path()));
+            // Name of runtime field is not static, it is copied
+            ParseResult<void>::Error error = {.code = ErrorCode::DuplicateKey};
+            error.set_text(field.name);
+
+            result = Deserializer::parse_error_at(std::move(error), tokens);
           } else {
-            auto field_result = Deserializer::parse<FieldType>(tokens);
-            if (!field_result.is_ok()) {
-              result.emplace(
-                  ParseResult<void>::convert_error(std::move(field_result)));
-            } else {
-              field.set(std::move(field_result).value());
-              result.emplace(ParseResult<void>::result());
-            }
+            result = Deserializer::parse_into(field.set_in_place(), tokens);
           }
         },
         fields...);
 
-    return result.value();
+    return result;
   }
 
   /**
-   * @return missing keys error message
+   * @tparam Tokens token stream type
+   * @tparam Args fields types
+   * @param tokens token stream
+   * @param index 0-based index of field in refs
+   * @param refs references to fields
+   * @return successful result without value or error
+   * @post if result is not error, parsed value is stored to field, which is
+   * parsed in place
+   */
+  template <typename Tokens, typename... Args>
+  static ParseResult<void> parse_ref(Tokens &tokens, const size_t index,
+                                     Args &...refs) {
+    auto result = ParseResult<void>::result();
+
+    detail::call_on_nth(
+        index,
+        [&](auto &ref) { result = Deserializer::parse_into(ref, tokens); },
+        refs...);
+
+    return result;
+  }
+
+  /**
+   * @tparam Args types of fields
+   * @param set flags of fields already parsed
+   * @return true if all fields are set or optional
    */
   template <typename... Args>
-  static std::string missing_keys_error(const Field<Args> &...fields) {
-    return (("Missing keys: " + ... +
-             (fields.is_ready() ? "" : (fields.name + ", "))) +
-            "got " + detail::Token::name<detail::Token::Type::EndObject>());
+  static bool all_ready(const std::array<bool, sizeof...(Args)> &set) {
+    size_t index = 0;
+
+    return ((set[index++] || detail::is_optional_v<Args>) && ... && true);
+  }
+
+  /**
+   * @brief Reset optional fields which were not set
+   *
+   * @tparam Args types of fields
+   * @param set flags of fields already parsed
+   * @param refs references to fields
+   */
+  template <typename... Args>
+  static void reset_unset(const std::array<bool, sizeof...(Args)> &set,
+                          Args &...refs) {
+    size_t index = 0;
+
+    (
+        [&](auto &ref) {
+          if constexpr (detail::is_optional_v<std::decay_t<decltype(ref)>>) {
+            if (!set[index]) {
+              ref.reset();
+            }
+          }
+          ++index;
+        }(refs),
+        ...);
+  }
+
+  /**
+   * @return missing keys error, names are referenced without copying if
+   * fields fit set of missing ones
+   */
+  template <const auto &names, typename... Args>
+  static ParseResult<void>::Error
+  missing_names_error(const std::array<bool, sizeof...(Args)> &set) {
+    auto ready = set;
+    size_t index = 0;
+
+    ((ready[index] = ready[index] || detail::is_optional_v<Args>, ++index),
+     ...);
+
+    if constexpr (sizeof...(Args) > 64) {
+      // Set of missing names does not fit mask, names are rendered now
+      return missing_keys_error(ready, names);
+    } else {
+      uint64_t missing = 0;
+      for (size_t field = 0; field < ready.size(); ++field) {
+        if (!ready[field]) {
+          missing |= uint64_t{1} << field;
+        }
+      }
+
+      return {.code = ErrorCode::MissingKeys,
+              .names = names.data(),
+              .missing = missing};
+    }
+  }
+
+  /**
+   * @brief Render names of missing fields, used when names are not static
+   * or do not fit set of missing ones
+   *
+   * @param ready flags of fields which are set or optional
+   * @param names names of fields
+   * @return missing keys error
+   */
+  template <size_t t_size>
+  static ParseResult<void>::Error
+  missing_keys_error(const std::array<bool, t_size> &ready,
+                     const std::array<std::string_view, t_size> &names) {
+    std::string missing;
+    for (size_t index = 0; index < t_size; ++index) {
+      if (!ready[index]) {
+        missing += names[index];
+        missing += ", ";
+      }
+    }
+
+    ParseResult<void>::Error error = {.code = ErrorCode::MissingKeys,
+                                      .names = nullptr};
+    error.set_text(std::move(missing));
+
+    return error;
   }
 };
 } // namespace ctjson
\ No newline at end of file
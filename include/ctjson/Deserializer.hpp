@@ -3,10 +3,13 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include <ctjson/Deserializable.hpp>
 #include <ctjson/ParseResult.hpp>
 
+#include <ctjson/detail/Convert.hpp>
 #include <ctjson/detail/Token.hpp>
 #include <ctjson/detail/TypeUtils.hpp>
 #include <ctjson/detail/Typing.hpp>
@@ -30,26 +33,65 @@ namespace ctjson {
 class Deserializer {
 public:
   /**
-   * @brief Specialization for values: numbers and strings (numbers,
-   * std::string)
+   * @brief Parse value from token stream
+   *
+   * Errors of nested values do not render path, as token stream stops at
+   * error, so it is rendered here once, @see parse_nested
+   *
+   * @param tokens token stream
+   * @return parse result, error has path in json
+   */
+  template <typename T, typename Tokens>
+  static inline ParseResult<T> parse(Tokens &tokens) {
+    return with_path(parse_nested<T>(tokens), tokens);
+  }
+
+  /**
+   * @brief Parse into existing value, reusing its capacity
+   *
+   * Usage example:
+   * @code{.cpp}
+   * MyType value;
+   * while (...) {
+   *   auto tokens = ...;
+   *   auto result = Deserializer::parse_into(value, tokens);
+   * }
+   * @endcode
+   *
+   * @param target value to parse into
+   * @param tokens token stream
+   * @return empty result if parsing was successful, error result otherwise,
+   * error has path in json
+   * @post if result is error, @ref target could be partially modified
+   */
+  template <typename T, typename Tokens>
+  static inline ParseResult<void> parse_into(T &target, Tokens &tokens) {
+    return with_path(parse_nested_into(target, tokens), tokens);
+  }
+
+  /**
+   * @brief Parse value nested in json being parsed, error has no path, it
+   * is rendered by outermost @ref parse
+   *
+   * Specialization for values: numbers and strings (numbers, std::string)
    */
   template <typename T, typename Tokens>
   static inline std::enable_if_t<detail::is_json_value<T>, ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     auto maybeToken = tokens.next();
     if (!maybeToken) {
-      if (tokens.has_error()) {
-        return ParseResult<T>::json_error(tokens.get_error(),
-                                          tokens.get_path());
-      } else {
-        return ParseResult<T>::parse_error(unexpected_end_error(),
-                                           tokens.get_path());
-      }
+      return no_token_error<T>(tokens);
     }
 
     auto &token = maybeToken.value();
 
-    return parse_value<T>(token, tokens.get_path());
+    T result = detail::make_value<T>(detail::memory_resource(tokens));
+    auto value_result = parse_value(result, token, tokens);
+    if (!value_result.is_ok()) {
+      return ParseResult<T>::convert_error(std::move(value_result));
+    }
+
+    return ParseResult<T>::result(std::move(result));
   }
 
   /**
@@ -57,19 +99,12 @@ public:
    */
   template <typename T, typename Tokens>
   static inline std::enable_if_t<detail::is_optional_v<T>, ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     using ValueType = typename T::value_type;
 
     const auto &maybeToken = tokens.peek();
     if (!maybeToken) {
-      if (tokens.has_error()) {
-        return ParseResult<T>::json_error(tokens.get_error(),
-                                          tokens.get_path());
-      } else {
-        // TODO: Provide better error
-        return ParseResult<T>::parse_error(unexpected_end_error(),
-                                           tokens.get_path());
-      }
+      return no_token_error<T>(tokens);
     }
 
     const auto &token = maybeToken.value();
@@ -79,7 +114,7 @@ public:
       return ParseResult<T>::result(std::nullopt);
     }
 
-    auto result = parse<ValueType>(tokens);
+    auto result = parse_nested<ValueType>(tokens);
     if (result.is_ok()) {
       return ParseResult<T>::result(std::move(result).value());
     }
@@ -90,45 +125,41 @@ public:
   /**
    * @brief Specialization for arrays (std::vector, std::set,
    * std::unordered_set)
+   *
+   * Capacity is reserved up front if token stream counts elements ahead,
+   * @see detail::reserve. Runs of numbers of std::vector are read at once if
+   * token stream supports it, @see read_numbers
    */
   template <typename T, typename Tokens>
   static inline std::enable_if_t<detail::is_array_like_v<T>, ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     using ValueType = typename T::value_type;
 
-    T result = {};
+    T result = detail::make_value<T>(detail::memory_resource(tokens));
 
     const auto maybeToken = tokens.next();
     if (!maybeToken) {
-      if (tokens.has_error()) {
-        return ParseResult<T>::json_error(tokens.get_error(),
-                                          tokens.get_path());
-      } else {
-        // TODO: Provide better error
-        return ParseResult<T>::parse_error(unexpected_end_error(),
-                                           tokens.get_path());
-      }
+      return no_token_error<T>(tokens);
     }
 
     const auto &token = maybeToken.value();
     if (!token.template is_of_type<detail::Token::Type::StartArray>()) {
       // TODO: Provide better error
-      return ParseResult<T>::parse_error(
+      return parse_error_at<T>(
           unexpected_token_error<detail::Token::Type::StartArray>(token),
-          tokens.get_path());
+          tokens);
     }
+    detail::reserve(result, tokens);
 
     while (true) {
+      if constexpr (detail::is_array_like<T>::is_sequence) {
+        size_t size = result.size();
+        read_numbers(result, size, tokens);
+      }
+
       const auto &maybeToken = tokens.peek();
       if (!maybeToken) {
-        if (tokens.has_error()) {
-          return ParseResult<T>::json_error(tokens.get_error(),
-                                            tokens.get_path());
-        } else {
-          // TODO: Provide better error
-          return ParseResult<T>::parse_error(unexpected_end_error(),
-                                             tokens.get_path());
-        }
+        return no_token_error<T>(tokens);
       }
 
       const auto &token = maybeToken.value();
@@ -138,7 +169,7 @@ public:
         return ParseResult<T>::result(std::move(result));
       }
 
-      auto member_result = parse<ValueType>(tokens);
+      auto member_result = parse_nested<ValueType>(tokens);
       if (!member_result.is_ok()) {
         return ParseResult<T>::convert_error(std::move(member_result));
       }
@@ -148,65 +179,67 @@ public:
     }
   }
 
+  /**
+   * @brief Specialization for fixed-size arrays (std::array), json array
+   * should have exactly the same number of elements
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_fixed_array_v<T>, ParseResult<T>>
+  parse_nested(Tokens &tokens) {
+    T result = {};
+    auto into_result = parse_nested_into(result, tokens);
+    if (!into_result.is_ok()) {
+      return ParseResult<T>::convert_error(std::move(into_result));
+    }
+
+    return ParseResult<T>::result(std::move(result));
+  }
+
   /**
    * @brief Specialization for dicts (std::map, std::unordered_map)
    */
   template <typename T, typename Tokens>
   static inline std::enable_if_t<detail::is_dict_like_v<T>, ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     using ValueType = typename T::mapped_type;
 
-    T result = {};
+    T result = detail::make_value<T>(detail::memory_resource(tokens));
 
     const auto maybeToken = tokens.next();
     if (!maybeToken) {
-      if (tokens.has_error()) {
-        return ParseResult<T>::json_error(tokens.get_error(),
-                                          tokens.get_path());
-      } else {
-        // TODO: Provide better error
-        return ParseResult<T>::parse_error(unexpected_end_error(),
-                                           tokens.get_path());
-      }
+      return no_token_error<T>(tokens);
     }
 
     const auto &token = maybeToken.value();
     if (!token.template is_of_type<detail::Token::Type::StartObject>()) {
       // TODO: Provide better error
-      return ParseResult<T>::parse_error(
+      return parse_error_at<T>(
           unexpected_token_error<detail::Token::Type::StartObject>(token),
-          tokens.get_path());
+          tokens);
     }
 
     while (true) {
-      const auto &maybeToken = tokens.next();
+      auto maybeToken = tokens.next();
       if (!maybeToken) {
-        if (tokens.has_error()) {
-          return ParseResult<T>::json_error(tokens.get_error(),
-                                            tokens.get_path());
-        } else {
-          // TODO: Provide better error
-          return ParseResult<T>::parse_error(unexpected_end_error(),
-                                             tokens.get_path());
-        }
+        return no_token_error<T>(tokens);
       }
 
-      const auto &token = maybeToken.value();
+      auto &token = maybeToken.value();
       if (token.template is_of_type<detail::Token::Type::EndObject>()) {
         return ParseResult<T>::result(std::move(result));
       }
 
       if (!token.template is_of_type<detail::Token::Type::Key>()) {
         // TODO: Provide better error
-        return ParseResult<T>::parse_error(
+        return parse_error_at<T>(
             unexpected_token_error<detail::Token::Type::Key,
                                    detail::Token::Type::EndObject>(token),
-            tokens.get_path());
+            tokens);
       }
 
       auto key = std::move(token.template value<detail::Token::Type::Key>());
 
-      auto member_result = parse<ValueType>(tokens);
+      auto member_result = parse_nested<ValueType>(tokens);
       if (!member_result.is_ok()) {
         return ParseResult<T>::convert_error(std::move(member_result));
       }
@@ -222,107 +255,563 @@ public:
   template <typename T, typename Tokens>
   static inline std::enable_if_t<
       detail::has_parse_v<T, ParseResult<T>, Tokens &>, ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     return T::json_parse(tokens);
   }
 
+  /**
+   * @brief Specialization for classes that implement only json_parse_into
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<
+      detail::has_parse_into_v<T, ParseResult<void>, T &, Tokens &> &&
+          !detail::has_parse_v<T, ParseResult<T>, Tokens &>,
+      ParseResult<T>>
+  parse_nested(Tokens &tokens) {
+    T result = {};
+    auto into_result = T::json_parse_into(result, tokens);
+    if (!into_result.is_ok()) {
+      return ParseResult<T>::convert_error(std::move(into_result));
+    }
+
+    return ParseResult<T>::result(std::move(result));
+  }
+
   /**
    * @brief Specialization for classes which has Deserializable instantiated
    */
   template <typename T, typename Tokens>
   static inline std::enable_if_t<Deserializable<T, Tokens>::value,
                                  ParseResult<T>>
-  parse(Tokens &tokens) {
+  parse_nested(Tokens &tokens) {
     return Deserializable<T, Tokens>::parse(tokens);
   }
 
+  /**
+   * @brief Parse into existing value nested in json being parsed
+   *
+   * Specialization for values: numbers and strings (numbers, std::string).
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_json_value<T>, ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    auto maybeToken = tokens.next();
+    if (!maybeToken) {
+      return no_token_error(tokens);
+    }
+
+    return parse_value(target, maybeToken.value(), tokens);
+  }
+
+  /**
+   * @brief Parse into existing optional, contained value is reused
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_optional_v<T>, ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    using ValueType = typename T::value_type;
+
+    const auto &maybeToken = tokens.peek();
+    if (!maybeToken) {
+      return no_token_error(tokens);
+    }
+
+    if (maybeToken->template is_of_type<detail::Token::Type::Null>()) {
+      tokens.next();
+      target.reset();
+
+      return ParseResult<void>::result();
+    }
+
+    if (!target) {
+      target.emplace(
+          detail::make_value<ValueType>(detail::memory_resource(tokens)));
+    }
+
+    return parse_nested_into(target.value(), tokens);
+  }
+
+  /**
+   * @brief Parse into existing array
+   *
+   * Elements of std::vector are parsed in place, nodes of sets are reused.
+   * Capacity is kept, so it could be reserved by caller for expected size.
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_array_like_v<T>, ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    const auto maybeToken = tokens.next();
+    if (!maybeToken) {
+      return no_token_error(tokens);
+    }
+
+    const auto &token = maybeToken.value();
+    if (!token.template is_of_type<detail::Token::Type::StartArray>()) {
+      // TODO: Provide better error
+      return parse_error_at<void>(
+          unexpected_token_error<detail::Token::Type::StartArray>(token),
+          tokens);
+    }
+
+    if constexpr (detail::is_array_like<T>::is_sequence) {
+      detail::reserve(target, tokens);
+      return parse_sequence_into(target, tokens);
+    } else {
+      return parse_nodes_into(target, tokens);
+    }
+  }
+
+  /**
+   * @brief Parse into existing fixed-size array (std::array), elements are
+   * parsed in place
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_fixed_array_v<T>,
+                                 ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    const auto maybeToken = tokens.next();
+    if (!maybeToken) {
+      return no_token_error(tokens);
+    }
+
+    const auto &token = maybeToken.value();
+    if (!token.template is_of_type<detail::Token::Type::StartArray>()) {
+      // TODO: Provide better error
+      return parse_error_at<void>(
+          unexpected_token_error<detail::Token::Type::StartArray>(token),
+          tokens);
+    }
+
+    size_t size = 0;
+    while (true) {
+      read_numbers(target, size, tokens);
+
+      const auto &maybeToken = tokens.peek();
+      if (!maybeToken) {
+        return no_token_error(tokens);
+      }
+
+      const auto &token = maybeToken.value();
+      const bool is_end =
+          token.template is_of_type<detail::Token::Type::EndArray>();
+      if (is_end && size == target.size()) {
+        tokens.next();
+
+        return ParseResult<void>::result();
+      }
+      if (is_end) {
+        return parse_error_at({.code = ErrorCode::ArraySize,
+                               .elements = {.expected = target.size(),
+                                            .actual = size}},
+                              tokens);
+      }
+      if (size == target.size()) {
+        return parse_error_at(
+            unexpected_token_error<detail::Token::Type::EndArray>(token),
+            tokens);
+      }
+
+      auto member_result = parse_nested_into(target[size], tokens);
+      if (!member_result.is_ok()) {
+        return member_result;
+      }
+
+      ++size;
+    }
+  }
+
+  /**
+   * @brief Parse into existing dict, nodes with the same keys are reused
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<detail::is_dict_like_v<T>, ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    using KeyType = typename T::key_type;
+    using ValueType = typename T::mapped_type;
+
+    const auto maybeToken = tokens.next();
+    if (!maybeToken) {
+      return no_token_error(tokens);
+    }
+
+    const auto &token = maybeToken.value();
+    if (!token.template is_of_type<detail::Token::Type::StartObject>()) {
+      // TODO: Provide better error
+      return parse_error_at<void>(
+          unexpected_token_error<detail::Token::Type::StartObject>(token),
+          tokens);
+    }
+
+    // Nodes of previous members, reused for the same keys
+    T previous = std::move(target);
+    target.clear();
+
+    while (true) {
+      auto maybeToken = tokens.next();
+      if (!maybeToken) {
+        return no_token_error(tokens);
+      }
+
+      auto &token = maybeToken.value();
+      if (token.template is_of_type<detail::Token::Type::EndObject>()) {
+        return ParseResult<void>::result();
+      }
+
+      if (!token.template is_of_type<detail::Token::Type::Key>()) {
+        // TODO: Provide better error
+        return parse_error_at<void>(
+            unexpected_token_error<detail::Token::Type::Key,
+                                   detail::Token::Type::EndObject>(token),
+            tokens);
+      }
+
+      auto &key = token.template value<detail::Token::Type::Key>();
+      auto node = [&]() {
+        if constexpr (std::is_same_v<std::decay_t<decltype(key)>, KeyType>) {
+          return previous.extract(key);
+        } else {
+          return previous.extract(KeyType(
+              key, typename KeyType::allocator_type(previous.get_allocator())));
+        }
+      }();
+
+      if (node) {
+        auto member_result = parse_nested_into(node.mapped(), tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
+
+        target.insert(std::move(node));
+      } else {
+        auto value =
+            detail::make_value<ValueType>(detail::memory_resource(tokens));
+        auto member_result = parse_nested_into(value, tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
+
+        detail::is_dict_like<T>::emplace(target, std::move(key),
+                                         std::move(value));
+      }
+    }
+  }
+
+  /**
+   * @brief Parse into existing class that implements json_parse_into
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<
+      detail::has_parse_into_v<T, ParseResult<void>, T &, Tokens &>,
+      ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    return T::json_parse_into(target, tokens);
+  }
+
+  /**
+   * @brief Parse into existing class without json_parse_into, parsed value is
+   * assigned to @ref target
+   */
+  template <typename T, typename Tokens>
+  static inline std::enable_if_t<
+      !detail::has_parse_into_v<T, ParseResult<void>, T &, Tokens &> &&
+          (detail::has_parse_v<T, ParseResult<T>, Tokens &> ||
+           Deserializable<T, Tokens>::value),
+      ParseResult<void>>
+  parse_nested_into(T &target, Tokens &tokens) {
+    auto result = parse_nested<T>(tokens);
+    if (!result.is_ok()) {
+      return ParseResult<void>::convert_error(std::move(result));
+    }
+
+    target = std::move(result).value();
+    return ParseResult<void>::result();
+  }
+
   /**
    * @tparam t_types types of expected tokens
    * @param token unexpected token
-   * @return error message for unexpected token
+   * @return error for unexpected token
    */
-  template <detail::Token::Type... t_types>
-  static inline std::string unexpected_token_error(const detail::Token &token) {
-    return "Expected " + ((detail::Token::name<t_types>() + ",") + ...) +
-           " got " + token.name();
+  template <detail::Token::Type... t_types, typename Token>
+  static inline ParseResult<void>::Error
+  unexpected_token_error(const Token &token) {
+    return {.code = ErrorCode::UnexpectedToken,
+            .expected = static_cast<detail::TokenMask>(
+                (detail::token_mask(t_types) | ... | 0)),
+            .actual = token.type()};
   }
 
   /**
-   * @return error message for unexpected end of json
+   * @tparam t_actual type of unexpected token
+   * @tparam t_types types of expected tokens
+   * @return error for unexpected token
    */
-  static inline std::string unexpected_end_error() {
-    return "Unexpected end of json";
+  template <detail::Token::Type t_actual, detail::Token::Type... t_types>
+  static inline ParseResult<void>::Error unexpected_type_error() {
+    return {.code = ErrorCode::UnexpectedToken,
+            .expected = static_cast<detail::TokenMask>(
+                (detail::token_mask(t_types) | ... | 0)),
+            .actual = t_actual};
   }
 
-private:
-  template <typename T>
-  static inline ParseResult<T>
-  parse_value(detail::Token &token,
-              std::optional<std::string> path = std::nullopt) {
-    return parse_value_impl<T>(token, std::move(path),
-                               std::in_place_type<detail::ValueTokens>);
+  /**
+   * @return error for unexpected end of json
+   */
+  static inline ParseResult<void>::Error unexpected_end_error() {
+    return {.code = ErrorCode::UnexpectedEnd};
   }
 
   /**
-   * @brief Implementation of parsing json value from token
+   * @brief Complete error with current offset in token stream
    *
-   * @param token token to parse from
-   * @param path optional path in json of token (for error message)
+   * Path is not rendered: token stream stops at error, so it is rendered by
+   * outermost @ref parse
+   *
+   * @param error error without position
+   * @param tokens token stream
+   * @return parse error result at current offset
+   */
+  template <typename T = void, typename Tokens>
+  static inline ParseResult<T> parse_error_at(ParseResult<void>::Error error,
+                                              const Tokens &tokens) {
+    error.offset = detail::offset(tokens);
+
+    return ParseResult<T>::parse_error(std::move(error));
+  }
+
+  /**
+   * @return error result when there is no next token: json error or
+   * unexpected end of json
+   */
+  template <typename T = void, typename Tokens>
+  static inline ParseResult<T> no_token_error(const Tokens &tokens) {
+    if (!tokens.has_error()) {
+      // TODO: Provide better error
+      return parse_error_at<T>(unexpected_end_error(), tokens);
+    }
+
+    ParseResult<void>::Error error = {.code = ErrorCode::Json,
+                                      .offset = detail::offset(tokens)};
+    if constexpr (std::is_same_v<decltype(tokens.get_error()),
+                                 std::string_view>) {
+      // Error of token stream has static storage
+      error.text = tokens.get_error();
+    } else {
+      error.code = ErrorCode::Custom;
+      error.set_custom(tokens.get_error());
+    }
+
+    return ParseResult<T>::json_error(std::move(error));
+  }
+
+private:
+  /**
+   * @brief Complete error of result with current path in token stream,
+   * unless path is already known
+   *
+   * @param result parse result
+   * @param tokens token stream stopped at error
+   * @return result, with path if it is error
+   */
+  template <typename T, typename Tokens>
+  static inline ParseResult<T> with_path(ParseResult<T> result,
+                                         const Tokens &tokens) {
+    if (!result.is_ok()) {
+      result.set_path(tokens.get_path());
+    }
+
+    return result;
+  }
+
+  /**
+   * @brief Parse array elements into std::vector in place
+   * @pre StartArray token is consumed
    */
-  template <typename T, typename Head, typename... Tail>
-  static inline ParseResult<T>
-  parse_value_impl(detail::Token &token, std::optional<std::string> path,
-                   std::in_place_type_t<detail::TokenList<Head, Tail...>>) {
-    using ValueType = typename Head::value_type;
-    constexpr auto t_type = Head::type;
-
-    if (!token.is_of_type<t_type>()) {
-      if constexpr (sizeof...(Tail) > 0) {
-        return parse_value_impl<T, Tail...>(
-            token, std::move(path),
-            std::in_place_type<detail::TokenList<Tail...>>);
+  template <typename T, typename Tokens>
+  static inline ParseResult<void> parse_sequence_into(T &target,
+                                                      Tokens &tokens) {
+    using ValueType = typename T::value_type;
+
+    size_t size = 0;
+    while (true) {
+      read_numbers(target, size, tokens);
+
+      const auto &maybeToken = tokens.peek();
+      if (!maybeToken) {
+        return no_token_error(tokens);
+      }
+
+      if (maybeToken->template is_of_type<detail::Token::Type::EndArray>()) {
+        tokens.next();
+        target.erase(target.begin() + size, target.end());
+
+        return ParseResult<void>::result();
+      }
+
+      if (size == target.size()) {
+        target.push_back(
+            detail::make_value<ValueType>(detail::memory_resource(tokens)));
+      }
+
+      if constexpr (std::is_same_v<ValueType, bool>) {
+        // std::vector<bool> has no references to elements
+        bool value = false;
+        auto member_result = parse_nested_into(value, tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
+        target[size] = value;
       } else {
-        // TODO: Provide better error
-        return ParseResult<T>::parse_error("Unexpected " + token.name(),
-                                           std::move(path));
+        auto member_result = parse_nested_into(target[size], tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
       }
+
+      ++size;
     }
+  }
+
+  /**
+   * @brief Read run of numbers into array of numbers at once, if token stream
+   * supports it, @see IndexedTokenStream::read_numbers
+   *
+   * Numbers are converted and range checked in one loop, without tokens and
+   * results per element. Numbers which could not be converted are left to
+   * parsing element by element, so errors are reported the same way.
+   *
+   * @param target std::vector or std::array, elements before @ref size are
+   * kept
+   * @param size number of elements already read, updated
+   */
+  template <typename T, typename Tokens>
+  static inline void read_numbers(T &target, size_t &size, Tokens &tokens) {
+    using ValueType = typename T::value_type;
+
+    if constexpr (std::is_arithmetic_v<ValueType> &&
+                  !std::is_same_v<ValueType, bool> &&
+                  detail::has_read_numbers<Tokens>::value) {
+      tokens.read_numbers([&target, &size](const auto number) {
+        ValueType value = 0;
+        if (detail::convert_value(value, number) != detail::Conversion::Ok) {
+          return false;
+        }
 
-    constexpr bool t_is_bool = std::is_same_v<T, bool>;
-    constexpr bool v_is_bool = std::is_same_v<ValueType, bool>;
-    constexpr bool t_is_integer =
-        !t_is_bool && std::numeric_limits<T>::is_integer;
-    constexpr bool v_is_integer =
-        !v_is_bool && std::numeric_limits<ValueType>::is_integer;
-    constexpr bool t_is_floating = std::is_floating_point_v<T>;
-    constexpr bool v_is_floating = std::is_floating_point_v<ValueType>;
-
-    constexpr bool is_bool = t_is_bool && v_is_bool;
-    constexpr bool is_integer = t_is_integer && v_is_integer;
-    constexpr bool is_floating =
-        (v_is_integer || v_is_floating) && t_is_floating;
-    constexpr bool is_string = std::is_same_v<ValueType, std::string> &&
-                               std::is_same_v<T, std::string>;
-
-    auto &value = token.value<t_type>();
-    if constexpr (is_bool) {
-      return ParseResult<T>::result(value);
-    } else if constexpr (is_integer) {
-      if (detail::in_range<T>(value)) {
-        return ParseResult<T>::result(static_cast<T>(value));
+        if constexpr (detail::is_fixed_array_v<T>) {
+          if (size == target.size()) {
+            return false;
+          }
+          target[size] = value;
+        } else if (size < target.size()) {
+          target[size] = value;
+        } else {
+          target.push_back(value);
+        }
+        ++size;
+
+        return true;
+      });
+    }
+  }
+
+  /**
+   * @brief Parse array elements into set, reusing its nodes
+   * @pre StartArray token is consumed
+   */
+  template <typename T, typename Tokens>
+  static inline ParseResult<void> parse_nodes_into(T &target, Tokens &tokens) {
+    using ValueType = typename T::value_type;
+
+    // Nodes of previous elements, reused for new ones
+    T previous = std::move(target);
+    target.clear();
+    detail::reserve(target, tokens);
+
+    while (true) {
+      const auto &maybeToken = tokens.peek();
+      if (!maybeToken) {
+        return no_token_error(tokens);
+      }
+
+      if (maybeToken->template is_of_type<detail::Token::Type::EndArray>()) {
+        tokens.next();
+
+        return ParseResult<void>::result();
+      }
+
+      if (!previous.empty()) {
+        auto node = previous.extract(previous.begin());
+        auto member_result = parse_nested_into(node.value(), tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
+
+        target.insert(std::move(node));
       } else {
-        // TODO: Provide better error
-        return ParseResult<T>::parse_error("Integer value not in range",
-                                           std::move(path));
+        auto value =
+            detail::make_value<ValueType>(detail::memory_resource(tokens));
+        auto member_result = parse_nested_into(value, tokens);
+        if (!member_result.is_ok()) {
+          return member_result;
+        }
+
+        detail::is_array_like<T>::emplace(target, std::move(value));
       }
-    } else if constexpr (is_floating) {
-      return ParseResult<T>::result(static_cast<T>(value));
-    } else if constexpr (is_string) {
-      return ParseResult<T>::result(std::move(value));
-    } else {
+    }
+  }
+
+  /**
+   * @brief Parse json value from token, dispatching once on its type
+   *
+   * Converter for each token type is selected at compile time for @tparam T,
+   * tokens which are not values convertible to T produce error without
+   * conversion.
+   *
+   * @param target value to store result
+   * @param token token to parse from
+   * @param tokens token stream, path is retrieved only on error
+   */
+  template <typename T, typename Token, typename Tokens>
+  static inline ParseResult<void> parse_value(T &target, Token &token,
+                                              const Tokens &tokens) {
+    static_assert(!std::is_same_v<T, std::string_view> ||
+                      std::is_same_v<typename Token::string_type,
+                                     std::string_view>,
+                  "std::string_view could be parsed only from in-situ token "
+                  "stream, otherwise it would dangle");
+
+    return token.visit([&target, &tokens](auto &exact) {
+      using ExactToken = std::decay_t<decltype(exact)>;
+      constexpr auto t_type = ExactToken::type;
+
+      if constexpr (is_convertible_token<T, typename Token::ValueTokens,
+                                         ExactToken>()) {
+        switch (detail::convert_value(target, std::move(exact.value))) {
+        case detail::Conversion::Ok:
+          return ParseResult<void>::result();
+        case detail::Conversion::OutOfRange:
+          // TODO: Provide better error
+          return parse_error_at({.code = ErrorCode::OutOfRange}, tokens);
+        default:
+          break;
+        }
+      }
+
       // TODO: Provide better error
-      return ParseResult<T>::parse_error("Unexpected " + token.name(),
-                                         std::move(path));
+      return parse_error_at(unexpected_type_error<t_type>(), tokens);
+    });
+  }
+
+  /**
+   * @return true if @tparam ExactToken is one of @tparam ValueTokens and its
+   * value is convertible to @tparam T, @see detail::is_convertible_v
+   */
+  template <typename T, typename ValueTokens, typename ExactToken>
+  static constexpr bool is_convertible_token() {
+    if constexpr (ValueTokens::template contains<ExactToken>) {
+      return detail::is_convertible_v<T, typename ExactToken::value_type>;
+    } else {
+      return false;
     }
   }
 };
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory_resource>
+#include <optional>
+
+#include <ctjson/Deserializer.hpp>
+#include <ctjson/ParseResult.hpp>
+#include <ctjson/TokenStream.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Reader of a sequence of json documents: newline-delimited (NDJSON)
+ * or concatenated json
+ *
+ * All documents are parsed from the same token stream, so parser and its
+ * stack are reused. Error in one document does not stop reading: input is
+ * skipped up to the next line, which resynchronizes NDJSON, but not
+ * concatenated documents on one line.
+ *
+ * Usage example:
+ * @code{.cpp}
+ * DocumentStream<MyClass, rapidjson::StringStream> documents(
+ *     rapidjson::StringStream(ndjson.c_str()));
+ * while (auto result = documents.next()) {
+ *   ...
+ * }
+ * @endcode
+ *
+ * @tparam T type of each document
+ * @tparam InputStream rapidjson input stream
+ * @tparam Tokens token stream type
+ */
+template <typename T, typename InputStream,
+          typename Tokens = LazyContextTokenStream<InputStream>>
+class DocumentStream {
+public:
+  /**
+   * @param is input stream
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
+   */
+  explicit DocumentStream(
+      InputStream is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_tokens(std::move(is), resource) {}
+
+  /**
+   * @brief Parse next document
+   *
+   * @return parse result of next document or std::nullopt on end of input
+   */
+  std::optional<ParseResult<T>> next() {
+    if (!m_tokens.next_document()) {
+      return std::nullopt;
+    }
+
+    return Deserializer::parse<T>(m_tokens);
+  }
+
+private:
+  Tokens m_tokens;
+};
+
+} // namespace ctjson
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace ctjson {
+
+/**
+ * @brief Compile-time names of class fields - keys in json
+ *
+ * @tparam N number of fields
+ */
+template <size_t N>
+using FieldNames = std::array<std::string_view, N>;
+
+/**
+ * @brief Create compile-time names of class fields
+ *
+ * Usage example:
+ * @code{.cpp}
+ * struct MyClass {
+ *   constexpr static auto json_names = field_names("str", "integer");
+ * };
+ * @endcode
+ *
+ * @param names string literals
+ * @return array of names
+ */
+template <typename... Names>
+constexpr FieldNames<sizeof...(Names)> field_names(const Names &...names) {
+  return {std::string_view(names)...};
+}
+
+} // namespace ctjson
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <rapidjson/error/en.h>
+#include <rapidjson/reader.h>
+
+#include <ctjson/ParseResult.hpp>
+#include <ctjson/TokenStream.hpp>
+
+#include <ctjson/detail/SaxParser.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Trait to parse type T with FusedDeserializer in ctjson::parse
+ *
+ * To enable fused deserialization, instantiate this class like so:
+ * @code{.cpp}
+ * template <>
+ * struct FusedDeserializable<MyType> : public std::true_type {};
+ * @endcode
+ */
+template <typename T>
+struct FusedDeserializable : public std::false_type {};
+
+namespace detail {
+
+/**
+ * @brief Class implementing Handler concept from rapidjson, feeding events
+ * directly to push parser of T
+ */
+template <typename T>
+class FusedHandler {
+public:
+  FusedHandler(T &target, std::pmr::memory_resource *resource) {
+    m_context.resource = resource;
+    m_context.path = [this]() {
+      std::string path = "root";
+      m_parser.render_path(path);
+      return path;
+    };
+    m_parser.begin(target, m_context);
+  }
+
+  FusedHandler(const FusedHandler &) = delete;
+  FusedHandler &operator=(const FusedHandler &) = delete;
+
+  bool Null() { return dispatch<TokenType::Null>(); }
+  bool Bool(bool boolean) { return dispatch<TokenType::Bool>(boolean); }
+  bool Int(int integer) { return dispatch<TokenType::Int>(integer); }
+  bool Uint(unsigned integer) { return dispatch<TokenType::Uint>(integer); }
+  bool Int64(int64_t integer) { return dispatch<TokenType::Int64>(integer); }
+  bool Uint64(uint64_t integer) {
+    return dispatch<TokenType::Uint64>(integer);
+  }
+  bool Double(double number) { return dispatch<TokenType::Double>(number); }
+  bool RawNumber(const char *str, unsigned len, bool copy) {
+    return dispatch<TokenType::RawNumber>(std::string_view(str, len));
+  }
+  bool String(const char *str, unsigned len, bool copy) {
+    return dispatch<TokenType::String>(std::string_view(str, len));
+  }
+  bool StartObject() { return dispatch<TokenType::StartObject>(); }
+  bool Key(const char *str, unsigned len, bool copy) {
+    return dispatch<TokenType::Key>(std::string_view(str, len));
+  }
+  bool EndObject(unsigned size) {
+    return dispatch<TokenType::EndObject>(size);
+  }
+  bool StartArray() { return dispatch<TokenType::StartArray>(); }
+  bool EndArray(unsigned size) { return dispatch<TokenType::EndArray>(size); }
+
+  /**
+   * @return true if push parser failed
+   */
+  bool has_error() const { return m_context.error.has_value(); }
+
+  /**
+   * @return error of push parser
+   * @pre has_error() == true
+   */
+  ParseResult<void> &&get_error() { return std::move(m_context.error).value(); }
+
+  /**
+   * @return current path in json
+   */
+  std::string get_path() const { return m_context.path(); }
+
+private:
+  template <TokenType t_type, typename... Args>
+  bool dispatch(Args &&...args) {
+    return m_parser.template on<t_type>(std::forward<Args>(args)...) !=
+           SaxStatus::Error;
+  }
+
+private:
+  SaxContext m_context;
+  SaxParser<T> m_parser;
+};
+
+} // namespace detail
+
+/**
+ * @brief Class for parsing json directly to domain classes
+ *
+ * Parser events are fed to typed push parsers without materializing token
+ * stream, so there is no per-token dispatch in between. Classes with
+ * json_parse or Deserializable are still supported: their events are
+ * buffered and replayed through Deserializer.
+ *
+ * Usage example:
+ * @code{.cpp}
+ * rapidjson::StringStream ss(json);
+ * auto result = FusedDeserializer::parse<MyType>(ss);
+ * @endcode
+ */
+class FusedDeserializer {
+public:
+  /**
+   * @tparam T type of value to parse
+   * @param is rapidjson input stream
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
+   * @return parse result
+   */
+  template <typename T, typename InputStream>
+  static inline ParseResult<T> parse(
+      InputStream &is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    T result = detail::make_value<T>(resource);
+    detail::FusedHandler<T> handler(result, resource);
+    rapidjson::Reader reader;
+
+    const auto parse_result =
+        reader.Parse<flags | detail::StreamTraits<InputStream>::flags>(
+            is, handler);
+    if (handler.has_error()) {
+      auto error = ParseResult<T>::convert_error(handler.get_error());
+      error.set_path(handler.get_path());
+      return error;
+    }
+    if (parse_result.IsError()) {
+      auto error = ParseResult<T>::json_error(
+          {.code = ErrorCode::Json,
+           .offset = parse_result.Offset(),
+           .text = rapidjson::GetParseError_En(parse_result.Code())});
+      error.set_path(handler.get_path());
+      return error;
+    }
+
+    return ParseResult<T>::result(std::move(result));
+  }
+
+private:
+  // Parsing flags
+  constexpr static unsigned flags =
+      rapidjson::ParseFlag::kParseIterativeFlag |
+      rapidjson::ParseFlag::kParseTrailingCommasFlag;
+};
+
+} // namespace ctjson
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include <rapidjson/error/en.h>
+
+#include <ctjson/FusedDeserializer.hpp>
+#include <ctjson/ParseResult.hpp>
+
+#include <ctjson/detail/IncrementalReader.hpp>
+#include <ctjson/detail/Typing.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Status of incremental parsing after feeding input
+ */
+enum class FeedStatus {
+  NeedMoreInput, // Value is not complete yet
+  Done,          // Value is complete, @see IncrementalParser::finish
+  Error,         // Parsing failed, @see IncrementalParser::finish
+};
+
+/**
+ * @brief Parser of json fed in parts, e.g. as they are received from network
+ *
+ * Complete tokens of each part are passed to push parser of T right away, the
+ * same as used by FusedDeserializer, so parsing progresses while the rest
+ * of input is not received yet. Only incomplete token at the end of part is
+ * buffered, parts themselves are not retained.
+ *
+ * Usage example:
+ * @code{.cpp}
+ * IncrementalParser<MyType> parser;
+ * while (parser.feed(receive()) == FeedStatus::NeedMoreInput) {
+ * }
+ * auto result = parser.finish();
+ * @endcode
+ *
+ * @tparam T type of value to parse
+ */
+template <typename T>
+class IncrementalParser {
+public:
+  /**
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
+   */
+  explicit IncrementalParser(
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_value(detail::make_value<T>(resource)), m_handler(m_value, resource) {
+  }
+
+  IncrementalParser(const IncrementalParser &) = delete;
+  IncrementalParser &operator=(const IncrementalParser &) = delete;
+
+  /**
+   * @brief Parse next part of input
+   *
+   * @param data next part of input, not referenced after return
+   * @return status of parsing, input after complete value is ignored
+   */
+  FeedStatus feed(const std::string_view data) {
+    if (m_status != FeedStatus::NeedMoreInput) {
+      return m_status;
+    }
+
+    if (m_pending.empty()) {
+      // Fast path: part is read in place, only its incomplete end is copied
+      size_t consumed = 0;
+      update(m_reader.read(data, false, m_handler, consumed));
+      m_pending.assign(data.substr(consumed));
+      m_offset += consumed;
+    } else {
+      m_pending.append(data);
+      read(false);
+    }
+
+    return m_status;
+  }
+
+  /**
+   * @brief Finish parsing, when there is no more input
+   *
+   * @return parse result, json error if input ended before value is complete
+   */
+  ParseResult<T> finish() {
+    if (m_status == FeedStatus::NeedMoreInput) {
+      read(true);
+    }
+
+    if (m_handler.has_error()) {
+      auto error = ParseResult<T>::convert_error(m_handler.get_error());
+      error.set_path(m_handler.get_path());
+      return error;
+    }
+    if (m_status == FeedStatus::Error) {
+      auto error = ParseResult<T>::json_error(
+          {.code = ErrorCode::Json,
+           .offset = m_offset,
+           .text = rapidjson::GetParseError_En(m_reader.get_error())});
+      error.set_path(m_handler.get_path());
+      return error;
+    }
+
+    return ParseResult<T>::result(std::move(m_value));
+  }
+
+  /**
+   * @return status of parsing
+   */
+  FeedStatus status() const { return m_status; }
+
+private:
+  /**
+   * @brief Read buffered input, keeping its incomplete end
+   */
+  void read(const bool last) {
+    size_t consumed = 0;
+    update(m_reader.read(m_pending, last, m_handler, consumed));
+    m_pending.erase(0, consumed);
+    m_offset += consumed;
+  }
+
+  void update(const detail::ReadStatus status) {
+    switch (status) {
+    case detail::ReadStatus::NeedMoreInput:
+      m_status = FeedStatus::NeedMoreInput;
+      break;
+    case detail::ReadStatus::Done:
+      m_status = FeedStatus::Done;
+      break;
+    case detail::ReadStatus::Error:
+      m_status = FeedStatus::Error;
+      break;
+    }
+  }
+
+private:
+  T m_value;
+  detail::FusedHandler<T> m_handler;
+  detail::IncrementalReader m_reader;
+
+  // Incomplete token at the end of input fed so far
+  std::string m_pending;
+  // Offset in whole input of the beginning of m_pending, after error it is
+  // offset of invalid token
+  size_t m_offset = 0;
+  FeedStatus m_status = FeedStatus::NeedMoreInput;
+};
+
+} // namespace ctjson
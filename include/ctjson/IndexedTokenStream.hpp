@@ -0,0 +1,580 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rapidjson/error/en.h>
+
+#include <ctjson/detail/Decode.hpp>
+#include <ctjson/detail/LazyPath.hpp>
+#include <ctjson/detail/StructuralIndex.hpp>
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Token stream reading tokens from structural index of json in memory
+ *
+ * Positions of structural characters are found first for the whole input,
+ * @see detail::build_structural_index, then tokens are produced walking the
+ * index. Grammar, tokens, errors and path are the same as of
+ * LazyContextTokenStream, with trailing commas allowed and content after
+ * the root value ignored. Skipped values are checked only for structure:
+ * their strings and numbers are not decoded.
+ *
+ * Input should outlive this stream and be smaller than 4 GiB.
+ */
+class IndexedTokenStream {
+public:
+  // Type of tokens produced by this stream
+  using token_type = detail::Token;
+
+public:
+  /**
+   * @param json input
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
+   */
+  explicit IndexedTokenStream(
+      const std::string_view json,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_json(json), m_resource(resource) {
+    if (json.size() > std::numeric_limits<uint32_t>::max()) {
+      m_error = "Input is too large for structural index";
+      return;
+    }
+
+    // Unclosed string is reported when it is reached
+    m_unclosed_string = !detail::build_structural_index(json, m_index);
+  }
+
+  /**
+   * @return true if stream encountered error
+   */
+  bool has_error() const { return m_error.has_value(); }
+
+  /**
+   * @return memory resource for parsed values
+   */
+  std::pmr::memory_resource *memory_resource() const { return m_resource; }
+
+  /**
+   * @return error description, with static storage
+   * @pre has_error() == true
+   */
+  std::string_view get_error() const { return m_error.value(); }
+
+  /**
+   * @return offset in input of the last structural character read, at which
+   * error is detected if stream encountered it
+   */
+  size_t get_offset() const { return m_offset; }
+
+  /**
+   * @return true if parsing is complete
+   */
+  bool is_complete() const {
+    return m_state == State::Done && !m_token.has_value();
+  }
+
+  /**
+   * @brief Peek next token
+   * @return   std::nullopt if there is no next token,
+   *           reference to next token otherwise
+   */
+  const std::optional<token_type> &peek() {
+    acquire_token();
+
+    return m_token;
+  }
+
+  /**
+   * @brief Retrieve next token
+   * @return   std::nullopt if there is no next token,
+   *           next token otherwise
+   */
+  std::optional<token_type> next() {
+    if (!acquire_token()) {
+      return std::nullopt;
+    }
+
+    std::optional<token_type> result = std::move(m_token);
+    m_token.reset();
+
+    return result;
+  }
+
+  /**
+   * @brief Skip next value, walking structural index without decoding
+   * strings and numbers
+   *
+   * Path is updated as for a single value.
+   * @return true if value was skipped, false on error or end of json
+   */
+  bool skip_value() {
+    if (has_error() || is_complete()) {
+      return false;
+    }
+
+    if (m_token.has_value()) {
+      // Value is peeked, so its first token is already seen by on_advance
+      const bool is_object =
+          m_token->is_of_type<detail::Token::Type::StartObject>();
+      const bool is_array =
+          m_token->is_of_type<detail::Token::Type::StartArray>();
+      m_token.reset();
+      if (!is_object && !is_array) {
+        return true;
+      }
+
+      if (!skip_to(m_stack.size() - 1)) {
+        return false;
+      }
+      if (is_object) {
+        m_path.end_object();
+      } else {
+        m_path.end_array();
+      }
+
+      return true;
+    }
+
+    const size_t depth = m_stack.size();
+    if (!step(false)) {
+      return false;
+    }
+    if (m_token.has_value() &&
+        (m_token->is_of_type<detail::Token::Type::EndObject>() ||
+         m_token->is_of_type<detail::Token::Type::EndArray>())) {
+      // There is no value to skip, end token stays peeked
+      on_advance(m_token.value());
+      return false;
+    }
+    if (!skip_to(depth)) {
+      return false;
+    }
+    m_path.value();
+
+    return true;
+  }
+
+  /**
+   * @brief Count elements of array which start token was just retrieved,
+   * walking structural index without decoding
+   *
+   * @return number of elements, 0 if another token was retrieved
+   */
+  size_t size_hint() const {
+    if (m_token.has_value() || m_state != State::Element ||
+        m_stack.back().size != 0) {
+      return 0;
+    }
+
+    size_t count = 0;
+    size_t depth = 0;
+    for (size_t cursor = m_cursor; cursor < m_index.size(); ++cursor) {
+      switch (m_json[m_index[cursor]]) {
+      case '{':
+      case '[':
+        count += depth == 0;
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        if (depth == 0) {
+          return count;
+        }
+        --depth;
+        break;
+      case ':':
+      case ',':
+        break;
+      default:
+        // Each string or scalar starts with one structural character
+        count += depth == 0;
+        break;
+      }
+    }
+
+    return count;
+  }
+
+  /**
+   * @brief Read run of numbers of array being read without producing tokens
+   *
+   * Each number is parsed from input and passed to @ref sink with the type of
+   * its token value, @see detail::visit_number. Reading stops before element
+   * which is not a number or is rejected by sink, so it is read by next()
+   * as usual, with errors reported the same way.
+   *
+   * @param sink callable bool(V value), false leaves value unread
+   * @return number of elements read
+   */
+  template <typename Sink>
+  size_t read_numbers(Sink &&sink) {
+    size_t count = 0;
+    while (!m_token.has_value() && !has_error() &&
+           m_cursor < m_index.size()) {
+      const size_t offset = m_index[m_cursor];
+      const char c = m_json[offset];
+
+      if (m_state == State::ArrayNext) {
+        if (m_trailing_garbage || c != ',') {
+          break;
+        }
+        m_offset = offset;
+        ++m_cursor;
+        m_state = State::Element;
+        continue;
+      }
+      if (m_state != State::Element || (c != '-' && (c < '0' || c > '9'))) {
+        break;
+      }
+
+      size_t end = offset;
+      if (detail::visit_number(m_json, end, sink) !=
+          rapidjson::kParseErrorNone) {
+        break;
+      }
+
+      m_offset = offset;
+      ++m_cursor;
+      ++m_stack.back().size;
+      after_value();
+      m_trailing_garbage =
+          end < m_json.size() && !detail::is_scalar_end(m_json[end]);
+      m_path.value();
+      ++count;
+    }
+
+    return count;
+  }
+
+  /**
+   * @brief Get current path in json
+   *
+   * @return always current path in json
+   */
+  std::optional<std::string> get_path() const {
+    return m_path.render(
+        [this](const size_t offset) { return read_key(offset); });
+  }
+
+private:
+  /**
+   * @brief Expected input
+   */
+  enum class State : uint8_t {
+    // Root value
+    Root,
+    // Key or end of object, after '{' or ','
+    Key,
+    // ':' after key
+    Colon,
+    // Value of object member, after ':'
+    Value,
+    // ',' or end of object, after member
+    ObjectNext,
+    // Value or end of array, after '[' or ','
+    Element,
+    // ',' or end of array, after element
+    ArrayNext,
+    // Root value is complete
+    Done
+  };
+
+  /**
+   * @brief Object or array being parsed
+   */
+  struct Container {
+    bool is_array;
+    // Number of members or elements
+    unsigned size;
+  };
+
+  /**
+   * @brief Make sure that there is next token or end reached or error
+   * encountered
+   */
+  bool acquire_token() {
+    if (has_error() || is_complete()) {
+      return false;
+    }
+
+    if (!m_token.has_value() && step(true)) {
+      on_advance(m_token.value());
+    }
+
+    return m_token.has_value();
+  }
+
+  /**
+   * @brief Advance one token further
+   *
+   * @param decode produce tokens of strings and scalars, otherwise only
+   * tokens of objects and arrays are produced
+   * @return false on error or end of json
+   */
+  bool step(const bool decode) {
+    for (;;) {
+      const size_t offset =
+          m_cursor < m_index.size() ? m_index[m_cursor] : m_json.size();
+      m_offset = offset;
+      // Null character stands for end of input, as in rapidjson
+      const char c = offset < m_json.size() ? m_json[offset] : '\0';
+
+      switch (m_state) {
+      case State::Root:
+        if (offset == m_json.size()) {
+          return fail(rapidjson::kParseErrorDocumentEmpty);
+        }
+        return value(offset, decode);
+      case State::Key:
+        if (c == '}') {
+          return end_container<detail::Token::Type::EndObject>();
+        }
+        if (c != '"') {
+          return fail(rapidjson::kParseErrorObjectMissName);
+        }
+        ++m_cursor;
+        ++m_stack.back().size;
+        m_state = State::Colon;
+        m_key_offset = offset;
+        if (decode) {
+          return string<detail::Token::Type::Key>(offset);
+        }
+        m_token.reset();
+        return true;
+      case State::Colon:
+        if (c != ':') {
+          return fail(rapidjson::kParseErrorObjectMissColon);
+        }
+        ++m_cursor;
+        m_state = State::Value;
+        break;
+      case State::Value:
+        return value(offset, decode);
+      case State::ObjectNext:
+        if (m_trailing_garbage || (c != ',' && c != '}')) {
+          return fail(rapidjson::kParseErrorObjectMissCommaOrCurlyBracket);
+        }
+        if (c == '}') {
+          return end_container<detail::Token::Type::EndObject>();
+        }
+        ++m_cursor;
+        m_state = State::Key;
+        break;
+      case State::Element:
+        if (c == ']') {
+          return end_container<detail::Token::Type::EndArray>();
+        }
+        ++m_stack.back().size;
+        return value(offset, decode);
+      case State::ArrayNext:
+        if (m_trailing_garbage || (c != ',' && c != ']')) {
+          return fail(rapidjson::kParseErrorArrayMissCommaOrSquareBracket);
+        }
+        if (c == ']') {
+          return end_container<detail::Token::Type::EndArray>();
+        }
+        ++m_cursor;
+        m_state = State::Element;
+        break;
+      case State::Done:
+        return false;
+      }
+    }
+  }
+
+  /**
+   * @brief Produce first token of value at @ref offset
+   */
+  bool value(const size_t offset, const bool decode) {
+    const char c = offset < m_json.size() ? m_json[offset] : '\0';
+    switch (c) {
+    case '{':
+      ++m_cursor;
+      m_stack.push_back({false, 0});
+      m_state = State::Key;
+      m_token = detail::Token::create<detail::Token::Type::StartObject>();
+      return true;
+    case '[':
+      ++m_cursor;
+      m_stack.push_back({true, 0});
+      m_state = State::Element;
+      m_token = detail::Token::create<detail::Token::Type::StartArray>();
+      return true;
+    case '"':
+      ++m_cursor;
+      after_value();
+      if (decode) {
+        return string<detail::Token::Type::String>(offset);
+      }
+      if (m_unclosed_string && m_cursor == m_index.size()) {
+        return fail(rapidjson::kParseErrorStringMissQuotationMark);
+      }
+      m_token.reset();
+      return true;
+    case '}':
+    case ']':
+    case ':':
+    case ',':
+    case '\0':
+      return fail(rapidjson::kParseErrorValueInvalid);
+    default:
+      break;
+    }
+
+    ++m_cursor;
+    after_value();
+    if (!decode) {
+      // Scalar spans up to the next structural character
+      m_token.reset();
+      return true;
+    }
+
+    size_t end = offset;
+    const auto code = detail::parse_scalar(m_json, end, m_token);
+    if (code != rapidjson::kParseErrorNone) {
+      return fail(code);
+    }
+    // Rest of scalar is reported by the next step, as by rapidjson
+    m_trailing_garbage =
+        end < m_json.size() && !detail::is_scalar_end(m_json[end]);
+
+    return true;
+  }
+
+  /**
+   * @brief Produce token of string with opening quote at @ref offset
+   */
+  template <detail::TokenType t_type>
+  bool string(const size_t offset) {
+    std::string value;
+    const auto code = detail::decode_string(m_json, offset, value);
+    if (code != rapidjson::kParseErrorNone) {
+      return fail(code);
+    }
+
+    m_token = detail::Token::create<t_type>(std::move(value));
+    return true;
+  }
+
+  /**
+   * @brief Produce token of end of current object or array
+   */
+  template <detail::TokenType t_type>
+  bool end_container() {
+    ++m_cursor;
+    const unsigned size = m_stack.back().size;
+    m_stack.pop_back();
+    after_value();
+    m_token = detail::Token::create<t_type>(size);
+
+    return true;
+  }
+
+  /**
+   * @brief Update state after complete value
+   */
+  void after_value() {
+    m_trailing_garbage = false;
+    if (m_stack.empty()) {
+      m_state = State::Done;
+    } else if (m_stack.back().is_array) {
+      m_state = State::ArrayNext;
+    } else {
+      m_state = State::ObjectNext;
+    }
+  }
+
+  /**
+   * @brief Advance without decoding until nesting depth is @ref depth
+   */
+  bool skip_to(const size_t depth) {
+    while (m_stack.size() > depth) {
+      if (!step(false)) {
+        return false;
+      }
+    }
+    m_token.reset();
+
+    return true;
+  }
+
+  /**
+   * @brief Set error based on parse error code
+   *
+   * @return false
+   */
+  bool fail(const rapidjson::ParseErrorCode code) {
+    m_token.reset();
+    m_error = rapidjson::GetParseError_En(code);
+
+    return false;
+  }
+
+  /**
+   * @brief Update path on new token
+   */
+  void on_advance(const token_type &token) {
+    if (token.is_of_type<detail::Token::Type::StartObject>()) {
+      m_path.start_object();
+    } else if (token.is_of_type<detail::Token::Type::Key>()) {
+      m_path.key(m_key_offset);
+    } else if (token.is_of_type<detail::Token::Type::EndObject>()) {
+      m_path.end_object();
+    } else if (token.is_of_type<detail::Token::Type::StartArray>()) {
+      m_path.start_array();
+    } else if (token.is_of_type<detail::Token::Type::EndArray>()) {
+      m_path.end_array();
+    } else {
+      m_path.value();
+    }
+  }
+
+  /**
+   * @brief Read key back from input
+   *
+   * @param offset offset of opening quote of key
+   * @return decoded key
+   */
+  std::string read_key(const size_t offset) const {
+    std::string key;
+    detail::decode_string(m_json, offset, key);
+
+    return key;
+  }
+
+private:
+  std::string_view m_json;
+  std::pmr::memory_resource *m_resource;
+
+  // Positions of structural characters
+  std::vector<uint32_t> m_index;
+  // Input ends inside string
+  bool m_unclosed_string = false;
+  // Position in index of the next structural character
+  size_t m_cursor = 0;
+
+  State m_state = State::Root;
+  std::vector<Container> m_stack;
+  // Last scalar is followed by bytes that can not follow value
+  bool m_trailing_garbage = false;
+
+  std::optional<token_type> m_token = std::nullopt;
+  std::optional<std::string_view> m_error;
+  // Offset of the last structural character read
+  size_t m_offset = 0;
+
+  detail::LazyPath m_path;
+  // Offset of opening quote of last key
+  size_t m_key_offset = 0;
+};
+
+} // namespace ctjson
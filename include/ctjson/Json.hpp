@@ -1,24 +1,155 @@
 #pragma once
 
-#include <rapidjson/stringbuffer.h>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
 
+#include <rapidjson/memorystream.h>
+
+#include <ctjson/BufferWriter.hpp>
 #include <ctjson/Deserializer.hpp>
+#include <ctjson/FusedDeserializer.hpp>
+#include <ctjson/IndexedTokenStream.hpp>
 #include <ctjson/Serializer.hpp>
 #include <ctjson/SimpleWriter.hpp>
 #include <ctjson/TokenStream.hpp>
 
+#include <ctjson/detail/MappedFile.hpp>
+
+// Defining CTJSON_INDEXED_TOKEN_STREAM makes parse, parse_file and
+// parse_into use IndexedTokenStream instead of rapidjson reader
+
 namespace ctjson {
 
 /**
  * @brief Convinient function to parse json from string
+ *
+ * Types with FusedDeserializable instantiated are parsed with
+ * FusedDeserializer, others with Deserializer
  * @tparam T type of value to parse
  * @param json json string
+ * @param resource memory resource for parsed values with polymorphic
+ * allocators (std::pmr containers and strings), e.g. monotonic arena
  * @return parse result
  */
 template <typename T>
-inline ParseResult<T> parse(const std::string &json) {
+inline ParseResult<T>
+parse(const std::string &json,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
   rapidjson::StringStream ss(json.c_str());
-  ContextTokenStream<rapidjson::StringStream> tokens(std::move(ss));
+  if constexpr (FusedDeserializable<T>::value) {
+    return FusedDeserializer::parse<T>(ss, resource);
+  } else {
+#if defined(CTJSON_INDEXED_TOKEN_STREAM)
+    IndexedTokenStream tokens(json, resource);
+#else
+    LazyContextTokenStream<rapidjson::StringStream> tokens(std::move(ss),
+                                                           resource);
+#endif
+
+    return Deserializer::parse<T>(tokens);
+  }
+}
+
+/**
+ * @brief Convinient function to parse json from file
+ *
+ * File is mapped to memory and parsed without copying, with sequential access
+ * hint, so memory usage is bounded by size of result rather than input
+ * @tparam T type of value to parse
+ * @param path path to json file
+ * @param resource memory resource for parsed values with polymorphic
+ * allocators (std::pmr containers and strings)
+ * @return parse result, io error if file could not be read
+ */
+template <typename T>
+inline ParseResult<T> parse_file(
+    const std::string &path,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+  std::string error;
+  const auto file = detail::MappedFile::open(path, error);
+  if (!file) {
+    return ParseResult<T>::io_error(std::move(error));
+  }
+
+  rapidjson::MemoryStream ms(file->data(), file->size());
+  if constexpr (FusedDeserializable<T>::value) {
+    return FusedDeserializer::parse<T>(ms, resource);
+  } else {
+#if defined(CTJSON_INDEXED_TOKEN_STREAM)
+    IndexedTokenStream tokens(std::string_view(file->data(), file->size()),
+                              resource);
+#else
+    LazyContextTokenStream<rapidjson::MemoryStream> tokens(std::move(ms),
+                                                           resource);
+#endif
+
+    return Deserializer::parse<T>(tokens);
+  }
+}
+
+/**
+ * @brief Convenient function to parse json from string into existing value
+ *
+ * Containers and strings of @ref target are refilled in place, keeping their
+ * capacity, @see Deserializer::parse_into
+ * @tparam T type of value to parse
+ * @param target value to parse into
+ * @param json json string
+ * @return empty result if parsing was successful, error result otherwise
+ */
+template <typename T>
+inline ParseResult<void> parse_into(T &target, const std::string &json) {
+#if defined(CTJSON_INDEXED_TOKEN_STREAM)
+  IndexedTokenStream tokens(json);
+#else
+  rapidjson::StringStream ss(json.c_str());
+  LazyContextTokenStream<rapidjson::StringStream> tokens(std::move(ss));
+#endif
+
+  return Deserializer::parse_into(target, tokens);
+}
+
+/**
+ * @brief Convenient function to parse json with structural index
+ *
+ * Positions of structural characters are found with SIMD before parsing,
+ * @see IndexedTokenStream
+ * @tparam T type of value to parse
+ * @param json json string, not necessarily null-terminated
+ * @param resource memory resource for parsed values with polymorphic
+ * allocators (std::pmr containers and strings)
+ * @return parse result
+ */
+template <typename T>
+inline ParseResult<T> parse_indexed(
+    const std::string_view json,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+  IndexedTokenStream tokens(json, resource);
+
+  return Deserializer::parse<T>(tokens);
+}
+
+/**
+ * @brief Convenient function to parse json in-situ
+ *
+ * Strings are decoded in place without copying, so @ref json is modified
+ * and std::string_view values in result reference it
+ * @tparam T type of value to parse
+ * @param json mutable null-terminated json string
+ * @param resource memory resource for parsed values with polymorphic
+ * allocators (std::pmr containers and strings)
+ * @return parse result
+ */
+template <typename T>
+inline ParseResult<T> parse_insitu(
+    char *json,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+  rapidjson::InsituStringStream ss(json);
+  LazyContextTokenStream<rapidjson::InsituStringStream> tokens(std::move(ss),
+                                                               resource);
 
   return Deserializer::parse<T>(tokens);
 }
@@ -31,11 +162,50 @@ inline ParseResult<T> parse(const std::string &json) {
  */
 template <typename T>
 inline std::string dump(const T &value) {
-  rapidjson::StringBuffer sb;
-  SimpleWriter<rapidjson::StringBuffer> writer(sb);
+  BufferWriter writer;
+
+  Serializer::dump(value, writer);
+
+  return writer.release();
+}
+
+/**
+ * @brief Dump value to json string allocated once with exact size
+ *
+ * Value is traversed twice, @see Serializer::measure, so this is preferable
+ * for large values, when reallocations are more expensive
+ * @tparam T type of value
+ * @param value value to dump
+ * @return json string
+ */
+template <typename T>
+inline std::string dump_exact(const T &value) {
+  BufferWriter writer(Serializer::measure(value));
+
+  Serializer::dump(value, writer);
 
+  return writer.release();
+}
+
+/**
+ * @brief Dump value to json in caller-provided storage
+ *
+ * @tparam T type of value
+ * @param value value to dump
+ * @param data storage for json
+ * @param size size of @ref data, @see Serializer::measure
+ * @return size of json, std::nullopt if it does not fit @ref data, contents
+ * of @ref data are unspecified then
+ */
+template <typename T>
+inline std::optional<size_t> dump_to(const T &value, char *data,
+                                     const size_t size) {
+  BufferWriter writer(data, size);
   Serializer::dump(value, writer);
+  if (writer.overflowed()) {
+    return std::nullopt;
+  }
 
-  return sb.GetString();
+  return writer.view().size();
 }
 } // namespace ctjson
\ No newline at end of file
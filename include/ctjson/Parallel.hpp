@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <rapidjson/memorystream.h>
+
+#include <ctjson/DocumentStream.hpp>
+#include <ctjson/ParseResult.hpp>
+
+namespace ctjson {
+
+namespace detail {
+
+/**
+ * @brief Split newline-delimited json into chunks at line boundaries
+ *
+ * @param json newline-delimited json
+ * @param chunk_size minimal size of chunk in bytes, chunk is extended to the
+ * end of line
+ * @return chunks covering whole @ref json in order
+ */
+inline std::vector<std::string_view> split_lines(const std::string_view json,
+                                                 const size_t chunk_size) {
+  std::vector<std::string_view> chunks;
+  size_t begin = 0;
+  while (begin < json.size()) {
+    const auto size = std::max<size_t>(chunk_size, 1);
+    size_t end = std::min(json.find('\n', begin + size - 1), json.size());
+    if (end < json.size()) {
+      ++end;
+    }
+
+    chunks.push_back(json.substr(begin, end - begin));
+    begin = end;
+  }
+
+  return chunks;
+}
+
+/**
+ * @brief Pool of threads processing chunks, each chunk is processed by one
+ * thread
+ *
+ * First exception thrown by @ref process is rethrown in calling thread,
+ * remaining chunks are not processed then.
+ * @param count number of chunks
+ * @param threads number of threads, 0 for hardware concurrency
+ * @param process callable with chunk index
+ */
+template <typename Process>
+void for_each_chunk(const size_t count, size_t threads, Process &&process) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads = std::min(threads, count);
+
+  std::atomic<size_t> next_chunk = 0;
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  const auto worker = [&]() {
+    for (auto chunk = next_chunk++; chunk < count; chunk = next_chunk++) {
+      try {
+        process(chunk);
+      } catch (...) {
+        const std::lock_guard lock(exception_mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+        next_chunk = count;
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads);
+  for (size_t i = 1; i < threads; ++i) {
+    pool.emplace_back(worker);
+  }
+  // Calling thread is a worker too
+  worker();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+} // namespace detail
+
+// Default minimal size of chunk parsed by one thread
+constexpr size_t default_chunk_size = 1 << 20;
+
+/**
+ * @brief Parse newline-delimited json on several threads, calling
+ * @ref callback for each document in unspecified order
+ *
+ * Input is split into chunks at line boundaries, each chunk is parsed with
+ * its own token stream, @see DocumentStream.
+ * @tparam T type of each document
+ * @param json newline-delimited json, should outlive the call
+ * @param callback callable with ParseResult<T>&&, called concurrently from
+ * several threads
+ * @param threads number of threads, 0 for hardware concurrency
+ * @param chunk_size minimal size of chunk in bytes
+ */
+template <typename T, typename Callback>
+void parse_ndjson_parallel_unordered(
+    const std::string_view json, Callback &&callback, const size_t threads = 0,
+    const size_t chunk_size = default_chunk_size) {
+  const auto chunks = detail::split_lines(json, chunk_size);
+  detail::for_each_chunk(chunks.size(), threads, [&](const size_t chunk) {
+    DocumentStream<T, rapidjson::MemoryStream> documents(
+        rapidjson::MemoryStream(chunks[chunk].data(), chunks[chunk].size()));
+    while (auto result = documents.next()) {
+      callback(std::move(*result));
+    }
+  });
+}
+
+/**
+ * @brief Parse newline-delimited json on several threads
+ *
+ * @tparam T type of each document
+ * @param json newline-delimited json
+ * @param threads number of threads, 0 for hardware concurrency
+ * @param chunk_size minimal size of chunk in bytes
+ * @return parse results of documents in input order
+ */
+template <typename T>
+std::vector<ParseResult<T>>
+parse_ndjson_parallel(const std::string_view json, const size_t threads = 0,
+                      const size_t chunk_size = default_chunk_size) {
+  const auto chunks = detail::split_lines(json, chunk_size);
+  std::vector<std::vector<ParseResult<T>>> chunk_results(chunks.size());
+  detail::for_each_chunk(chunks.size(), threads, [&](const size_t chunk) {
+    DocumentStream<T, rapidjson::MemoryStream> documents(
+        rapidjson::MemoryStream(chunks[chunk].data(), chunks[chunk].size()));
+    while (auto result = documents.next()) {
+      chunk_results[chunk].push_back(std::move(*result));
+    }
+  });
+
+  std::vector<ParseResult<T>> results;
+  size_t count = 0;
+  for (const auto &chunk : chunk_results) {
+    count += chunk.size();
+  }
+  results.reserve(count);
+  for (auto &chunk : chunk_results) {
+    std::move(chunk.begin(), chunk.end(), std::back_inserter(results));
+  }
+
+  return results;
+}
+
+} // namespace ctjson
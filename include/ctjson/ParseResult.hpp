@@ -1,12 +1,44 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <ctjson/detail/Token.hpp>
 
 namespace ctjson {
 
+/**
+ * @brief Kind of error, selecting how its message is rendered
+ */
+enum class ErrorCode : uint8_t {
+  Custom,          // Message is given as string
+  Json,            // Invalid json, description is static text
+  UnexpectedToken, // Token is not of expected types
+  UnexpectedEnd,   // Json ended before value is complete
+  OutOfRange,      // Integer value does not fit target type
+  DuplicateKey,    // Key is repeated, key is static text
+  UnexpectedKey,   // Key is not a field of class
+  MissingKeys,     // Required fields are missing
+  ArraySize,       // Array has less elements than fixed-size array
+};
+
 namespace detail {
+/**
+ * @brief Parts of error which are allocated
+ */
+struct ErrorExtra {
+  std::string custom;
+  // Text without static storage: key from json or names of runtime fields
+  std::string text;
+};
+
 /**
  * @brief Base class for parse results
  *
@@ -19,80 +51,277 @@ protected:
     NO_ERROR,
     JSON_ERROR,  // Error in json structure
     PARSE_ERROR, // Error while parsing to domain
+    IO_ERROR,    // Error while reading input
+    TAKEN,       // Error is taken or result is moved from
   };
 
 public:
   /**
    * @brief Error information
+   *
+   * Error is recorded as code with plain data, message is rendered on
+   * request. Custom message and text without static storage are kept out
+   * of line and allocated only if they are given.
+   *
+   * Path is not rendered when error is raised: token stream stops at error,
+   * path is rendered once by outermost @ref Deserializer::parse
    */
   struct Error {
-    std::string error;               // Error message
-    std::optional<std::string> path; // Path in json
+    ErrorCode code = ErrorCode::Custom;
+    // Types of expected tokens, empty if token is unexpected at all
+    detail::TokenMask expected = 0;
+    // Type of unexpected token
+    detail::TokenType actual = detail::TokenType::Null;
+    // Offset in input where error was detected, npos if unknown
+    size_t offset = std::string::npos;
+    union {
+      // Text with static storage: json error description or key
+      std::string_view text = {};
+      // Names of fields for missing keys, null if they are not static,
+      // then missing names are kept as text out of line
+      const std::string_view *names;
+      // Numbers of elements for array size error
+      struct {
+        size_t expected;
+        size_t actual;
+      } elements;
+    };
+    // Set of missing fields, bit i stands for names[i]
+    uint64_t missing = 0;
+    // Custom message and owned text, null unless they are given
+    std::shared_ptr<const ErrorExtra> extra = nullptr;
+    // Path in json
+    std::optional<std::string> path = std::nullopt;
+
+    /**
+     * @return message of custom error
+     */
+    std::string_view custom() const {
+      return extra ? std::string_view(extra->custom) : std::string_view();
+    }
+
+    /**
+     * @param custom message of custom error
+     */
+    void set_custom(std::string custom) {
+      own_extra().custom = std::move(custom);
+    }
+
+    /**
+     * @brief Set text which has no static storage, it is used instead of
+     * @ref text
+     *
+     * @param text key or rendered names of missing fields
+     */
+    void set_text(std::string text) { own_extra().text = std::move(text); }
+
+    /**
+     * @deprecated Error is no longer a message, @see message, render
+     * @return error message
+     */
+    [[deprecated("Use message() or render()")]] std::string error() const {
+      return message();
+    }
 
+    /**
+     * @return error message
+     */
+    std::string message() const {
+      switch (code) {
+      case ErrorCode::Json:
+        return std::string(text);
+      case ErrorCode::UnexpectedToken:
+        return unexpected_token_message();
+      case ErrorCode::UnexpectedEnd:
+        return "Unexpected end of json";
+      case ErrorCode::OutOfRange:
+        return "Integer value not in range";
+      case ErrorCode::DuplicateKey:
+        return "Duplicate key: " + std::string(key());
+      case ErrorCode::UnexpectedKey:
+        return "Unexpected key: " + std::string(key());
+      case ErrorCode::MissingKeys:
+        return missing_keys_message();
+      case ErrorCode::ArraySize:
+        return "Expected " + std::to_string(elements.expected) +
+               " elements, got " + std::to_string(elements.actual);
+      case ErrorCode::Custom:
+        break;
+      }
+
+      return std::string(custom());
+    }
+
+    /**
+     * @return error message with path
+     */
     std::string render() const {
-      auto result = error;
+      auto result = message();
       if (path) {
         result += " at " + path.value();
       }
 
       return result;
     }
-  };
 
-protected:
-  ParseResultBase() = default;
-  ParseResultBase(ErrorType error_type, Error error)
-      : m_error_type(error_type), m_error(std::move(error)) {}
+  private:
+    /**
+     * @return copy of out of line part, which is not shared with other errors
+     */
+    ErrorExtra &own_extra() {
+      auto owned = std::make_shared<ErrorExtra>(extra ? *extra : ErrorExtra{});
+      extra = owned;
+      return *owned;
+    }
 
-protected:
-  const ErrorType m_error_type = ErrorType::NO_ERROR;
-  std::optional<Error> m_error = std::nullopt;
-};
+    /**
+     * @return key, owned or static one
+     */
+    std::string_view key() const {
+      return extra && !extra->text.empty() ? std::string_view(extra->text)
+                                           : text;
+    }
 
-/**
- * @brief Base class for parse results holding value
- */
-template <typename T>
-class ParseResultValue {
+    std::string unexpected_token_message() const {
+      if (expected == 0) {
+        return "Unexpected " + std::string(detail::token_name(actual));
+      }
+
+      std::string result = "Expected ";
+      for (unsigned type = 0;
+           type <= static_cast<unsigned>(detail::TokenType::EndArray);
+           ++type) {
+        const auto t_type = static_cast<detail::TokenType>(type);
+        if (expected & detail::token_mask(t_type)) {
+          result += detail::token_name(t_type);
+          result += ',';
+        }
+      }
+
+      return result + " got " + std::string(detail::token_name(actual));
+    }
+
+    std::string missing_keys_message() const {
+      std::string result = "Missing keys: ";
+      if (names == nullptr) {
+        // Names are rendered when error is raised
+        result += extra ? std::string_view(extra->text) : std::string_view();
+      } else {
+        for (size_t index = 0; index < 64; ++index) {
+          if (missing & (uint64_t{1} << index)) {
+            result += names[index];
+            result += ", ";
+          }
+        }
+      }
+
+      return result + "got " +
+             std::string(detail::token_name(detail::TokenType::EndObject));
+    }
+  };
 protected:
-  ParseResultValue() = default;
-  ParseResultValue(T value) : m_value(std::move(value)) {}
+  /**
+   * @brief Error with its type, allocated only on failure, so that results
+   * are small and errors are passed between nesting levels by pointer
+   */
+  struct Failure {
+    ErrorType type;
+    Error error;
+  };
 
-public:
   /**
-   * @return value of this result
+   * @brief Deleter of failure, which does not delete shared taken failure
    */
-  T value() && {
-    auto result = std::move(m_value.value());
-    return result;
+  struct FailureDeleter {
+    void operator()(Failure *failure) const noexcept {
+      if (failure != taken_failure()) {
+        delete failure;
+      }
+    }
+  };
+
+  using FailurePtr = std::unique_ptr<Failure, FailureDeleter>;
+
+  /**
+   * @return failure left in result after its error is taken or result is
+   * moved from, so that result is not mistaken for success; it is shared
+   * and never modified
+   */
+  static Failure *taken_failure() noexcept {
+    static Failure taken{ErrorType::TAKEN,
+                         custom_error("Error is taken from result")};
+    return &taken;
   }
 
-protected:
-  std::optional<T> m_value = std::nullopt;
+  static Error custom_error(std::string custom,
+                            std::optional<std::string> path = std::nullopt) {
+    Error error;
+    error.extra = std::make_shared<const detail::ErrorExtra>(
+        detail::ErrorExtra{std::move(custom), {}});
+    error.path = std::move(path);
+
+    return error;
+  }
+
+  static FailurePtr make_failure(ErrorType error_type, Error error) {
+    return FailurePtr(new Failure{error_type, std::move(error)});
+  }
+};
+
+/**
+ * @brief Storage of either value or failure
+ *
+ * @tparam T type of value
+ * @tparam FailurePtr owning pointer to failure
+ */
+template <typename T, typename FailurePtr>
+struct ResultStorage {
+  using type = std::variant<FailurePtr, T>;
 };
 
 /**
- * @brief Specialization for void - no value
+ * @brief Specialization for void - only failure, null if there is none
  */
-template <>
-class ParseResultValue<void> {};
+template <typename FailurePtr>
+struct ResultStorage<void, FailurePtr> {
+  using type = FailurePtr;
+};
 } // namespace detail
 
 /**
  * @brief Representation of parse result - error or value
+ *
+ * Value and error share storage and error is allocated out of line, so
+ * ParseResult<void> is one pointer. Result is move-only. Error does not fit
+ * inline without growing every result, so it is allocated once per failed
+ * parse and moved between nesting levels by pointer.
+ *
+ * Result, which error is taken or which is moved from with error, stays
+ * failed, its error reports that it is taken.
  */
 template <typename T>
-class ParseResult : public detail::ParseResultBase,
-                    public detail::ParseResultValue<T> {
+class ParseResult : public detail::ParseResultBase {
   template <typename U>
   friend class ParseResult;
 
+  using Storage = typename detail::ResultStorage<T, FailurePtr>::type;
+
+  /**
+   * @brief Error constructor
+   */
+  explicit ParseResult(FailurePtr failure) {
+    if constexpr (std::is_same_v<T, void>) {
+      m_storage = std::move(failure);
+    } else {
+      m_storage.template emplace<0>(std::move(failure));
+    }
+  }
+
   /**
    * @brief Error constructor
    */
   ParseResult(ErrorType error_type, Error error)
-      : detail::ParseResultBase(error_type, std::move(error)),
-        detail::ParseResultValue<T>() {}
+      : ParseResult(make_failure(error_type, std::move(error))) {}
 
   /**
    * @brief Value constructor, enabled only if T != void
@@ -100,17 +329,34 @@ class ParseResult : public detail::ParseResultBase,
   template <typename U = T,
             typename = std::enable_if_t<!std::is_same_v<U, void>>>
   ParseResult(std::enable_if_t<std::is_same_v<U, T>, U> value)
-      : detail::ParseResultBase(), detail::ParseResultValue<T>(
-                                       std::move(value)) {}
+      : m_storage(std::in_place_index<1>, std::move(value)) {}
 
   /**
    * @brief Value constructor, enabled only if T == void
    */
   template <typename U = T,
             typename = std::enable_if_t<std::is_same_v<U, void>>>
-  ParseResult() : detail::ParseResultBase(), detail::ParseResultValue<T>() {}
+  ParseResult() : m_storage() {}
 
 public:
+  ParseResult(ParseResult &&other) noexcept
+      : m_storage(std::move(other.m_storage)) {
+    if (!is_ok()) {
+      other.leave_taken();
+    }
+  }
+
+  ParseResult &operator=(ParseResult &&other) noexcept {
+    if (this != &other) {
+      m_storage = std::move(other.m_storage);
+      if (!is_ok()) {
+        other.leave_taken();
+      }
+    }
+
+    return *this;
+  }
+
   /**
    * @brief    Method for creating result with value,
    *           enabled if T == void
@@ -150,7 +396,17 @@ public:
   json_error(std::string error,
              std::optional<std::string> path = std::nullopt) {
     return ParseResult(ErrorType::JSON_ERROR,
-                       {.error = std::move(error), .path = std::move(path)});
+                       custom_error(std::move(error), std::move(path)));
+  }
+
+  /**
+   * @brief Method for creating result with error in json parsing
+   *
+   * @param error error information
+   * @return result containing json error
+   */
+  static ParseResult json_error(Error error) {
+    return ParseResult(ErrorType::JSON_ERROR, std::move(error));
   }
 
   /**
@@ -164,7 +420,27 @@ public:
   parse_error(std::string error,
               std::optional<std::string> path = std::nullopt) {
     return ParseResult(ErrorType::PARSE_ERROR,
-                       {.error = std::move(error), .path = std::move(path)});
+                       custom_error(std::move(error), std::move(path)));
+  }
+
+  /**
+   * @brief Method for creating result with error in parsing to domain
+   *
+   * @param error error information
+   * @return result containing parse error
+   */
+  static ParseResult parse_error(Error error) {
+    return ParseResult(ErrorType::PARSE_ERROR, std::move(error));
+  }
+
+  /**
+   * @brief Method for creating result with error in reading input
+   *
+   * @param error error message
+   * @return result containing io error
+   */
+  static ParseResult io_error(std::string error) {
+    return ParseResult(ErrorType::IO_ERROR, custom_error(std::move(error)));
   }
 
   /**
@@ -176,31 +452,114 @@ public:
    */
   template <typename U>
   static ParseResult convert_error(ParseResult<U> &&other) {
-    return ParseResult(other.m_error_type, std::move(other.m_error.value()));
+    return ParseResult(other.take_failure());
+  }
+
+  /**
+   * @brief Set path in json where error occured, unless it is already known
+   *
+   * @param path path in json
+   * @pre this.is_ok() == false
+   */
+  void set_path(std::optional<std::string> path) {
+    auto failure = take_failure();
+    if (failure.get() != taken_failure() && !failure->error.path) {
+      failure->error.path = std::move(path);
+    }
+    *this = ParseResult(std::move(failure));
   }
 
   /**
    * @return true if this contains json error
    */
-  bool is_json_error() const { return m_error_type == ErrorType::JSON_ERROR; }
+  bool is_json_error() const { return error_type() == ErrorType::JSON_ERROR; }
 
   /**
    * @return true if this contains parse error
    */
-  bool is_parse_error() const { return m_error_type == ErrorType::PARSE_ERROR; }
+  bool is_parse_error() const {
+    return error_type() == ErrorType::PARSE_ERROR;
+  }
+
+  /**
+   * @return true if this contains io error
+   */
+  bool is_io_error() const { return error_type() == ErrorType::IO_ERROR; }
 
   /**
    * @return true if this contains value
    */
-  bool is_ok() const { return m_error_type == ErrorType::NO_ERROR; }
+  bool is_ok() const { return failure() == nullptr; }
+
+  /**
+   * @return value of this result
+   * @pre this.is_ok() == true
+   */
+  template <typename U = T,
+            typename = std::enable_if_t<!std::is_same_v<U, void>>>
+  U value() && {
+    return std::move(std::get<1>(m_storage));
+  }
 
   /**
    * @return Error information
    * @pre this.is_ok() == false
    */
   Error error() && {
-    auto result = std::move(m_error.value());
-    return result;
+    auto failure = take_failure();
+    if (failure.get() == taken_failure()) {
+      return failure->error;
+    }
+
+    return std::move(failure->error);
   }
+
+private:
+  /**
+   * @return failure, nullptr if result is ok
+   */
+  const Failure *failure() const {
+    if constexpr (std::is_same_v<T, void>) {
+      return m_storage.get();
+    } else {
+      const auto *failure = std::get_if<0>(&m_storage);
+      return failure != nullptr ? failure->get() : nullptr;
+    }
+  }
+
+  ErrorType error_type() const {
+    const auto *failure = this->failure();
+    return failure != nullptr ? failure->type : ErrorType::NO_ERROR;
+  }
+
+  /**
+   * @pre this.is_ok() == false
+   * @post this.is_ok() == false
+   */
+  FailurePtr take_failure() {
+    FailurePtr failure;
+    if constexpr (std::is_same_v<T, void>) {
+      failure = std::move(m_storage);
+    } else {
+      failure = std::move(std::get<0>(m_storage));
+    }
+    leave_taken();
+
+    return failure;
+  }
+
+  /**
+   * @brief Mark result as failed after its failure is moved out
+   */
+  void leave_taken() noexcept {
+    if constexpr (std::is_same_v<T, void>) {
+      m_storage.reset(taken_failure());
+    } else {
+      m_storage.template emplace<0>(taken_failure());
+    }
+  }
+
+private:
+  Storage m_storage;
 };
-} // namespace ctjson
\ No newline at end of file
+} // namespace ctjson
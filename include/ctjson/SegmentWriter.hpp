@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <ctjson/BufferWriter.hpp>
+
+#include <ctjson/detail/Escape.hpp>
+#include <ctjson/detail/StringScan.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Writer of json as scatter/gather segments
+ *
+ * Long runs of string bytes that do not need escaping are referenced in
+ * place instead of being copied, everything else is written to own buffer as
+ * by BufferWriter. Result can be passed to writev or sendmsg:
+ * @code{.cpp}
+ * SegmentWriter writer;
+ * Serializer::dump(value, writer);
+ * const auto segments = writer.segments();
+ * ::writev(fd, segments.data(), segments.size());
+ * @endcode
+ *
+ * Referenced strings should outlive segments.
+ */
+class SegmentWriter : private BufferWriter {
+public:
+  // Default minimal size of referenced run of string
+  constexpr static size_t default_min_reference_size = 256;
+
+  /**
+   * @param min_reference_size minimal size of run of string bytes that do
+   * not need escaping to reference it in place, shorter runs are copied
+   * @param capacity initial capacity of own buffer
+   */
+  explicit SegmentWriter(
+      const size_t min_reference_size = default_min_reference_size,
+      const size_t capacity = 256)
+      : BufferWriter(capacity), m_min_reference_size(min_reference_size) {}
+
+  using BufferWriter::boolean;
+  using BufferWriter::end_array;
+  using BufferWriter::end_object;
+  using BufferWriter::floating;
+  using BufferWriter::integer;
+  using BufferWriter::is_complete;
+  using BufferWriter::key;
+  using BufferWriter::null;
+  using BufferWriter::raw_key;
+  using BufferWriter::set_float_precision;
+  using BufferWriter::start_array;
+  using BufferWriter::start_object;
+
+  void string(std::string_view value) {
+    if (value.size() < m_min_reference_size) {
+      BufferWriter::string(value);
+      return;
+    }
+
+    value_prefix();
+    m_buffer.put('"');
+    size_t copied = 0; // Start of bytes not written yet
+    for (size_t run = 0; run <= value.size();) {
+      // End of run of bytes not needing escaping
+      const auto end = run + detail::find_special(value.data() + run,
+                                                  value.size() - run, false);
+      if (end - run >= m_min_reference_size) {
+        write_escaped(value.substr(copied, run - copied));
+        reference(value.substr(run, end - run));
+        copied = end;
+      }
+      run = end + 1;
+    }
+    write_escaped(value.substr(copied));
+    m_buffer.put('"');
+  }
+
+  /**
+   * @return segments of written json, valid until next write
+   */
+  std::vector<iovec> segments() const {
+    std::vector<iovec> result;
+    result.reserve(m_segments.size() + 1);
+
+    const auto owned = m_buffer.view();
+    const auto add = [&result](const char *data, const size_t size) {
+      if (size > 0) {
+        result.push_back({const_cast<char *>(data), size});
+      }
+    };
+    size_t offset = 0;
+    for (const auto &segment : m_segments) {
+      add(owned.data() + offset, segment.offset - offset);
+      add(segment.data, segment.size);
+      offset = segment.offset;
+    }
+    add(owned.data() + offset, owned.size() - offset);
+
+    return result;
+  }
+
+  /**
+   * @return total size of written json
+   */
+  size_t size() const { return m_buffer.size() + m_referenced_size; }
+
+private:
+  /**
+   * @brief Referenced bytes, placed before @ref offset in own buffer
+   */
+  struct Segment {
+    size_t offset;
+    const char *data;
+    size_t size;
+  };
+
+  /**
+   * @brief Write escaped part of string to own buffer, without quotes
+   */
+  void write_escaped(const std::string_view part) {
+    char *out = m_buffer.reserve(part.size());
+    m_buffer.commit(detail::write_escaped(m_buffer, out, part, 0));
+  }
+
+  /**
+   * @brief Reference part of string in place
+   */
+  void reference(const std::string_view part) {
+    m_segments.push_back({m_buffer.size(), part.data(), part.size()});
+    m_referenced_size += part.size();
+  }
+
+  size_t m_min_reference_size;
+  std::vector<Segment> m_segments;
+  size_t m_referenced_size = 0;
+};
+
+} // namespace ctjson
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <string>
+#include <utility>
 
+#include <ctjson/FieldNames.hpp>
 #include <ctjson/Serializer.hpp>
 
 #include <ctjson/detail/Field.hpp>
+#include <ctjson/detail/KeyFragments.hpp>
+#include <ctjson/detail/Typing.hpp>
 
 namespace ctjson {
 
@@ -72,5 +76,62 @@ public:
 
     writer.end_object();
   }
+
+  /**
+   * @brief Dump class with compile-time field names
+   *
+   * Keys are escaped at compile time and written together with separators,
+   * one copy per field, if writer supports it (@see BufferWriter::raw_key).
+   *
+   * Usage example:
+   * @code{.cpp}
+   * struct DumpClass {
+   *   std::string str;
+   *   int integer;
+   *
+   *   constexpr static auto json_names = field_names("str", "integer");
+   *
+   *   template<typename Writer>
+   *   static void json_dump(const DumpClass& object, Writer &writer) {
+   *       SerializationHelper::dump<json_names>(writer, object.str,
+   *                                             object.integer);
+   *   }
+   * };
+   * @endcode
+   *
+   * @tparam names reference to constexpr field names, @see field_names
+   * @tparam Writer type of writer
+   * @tparam Args types of fields
+   * @param writer writer
+   * @param refs references to fields, in order of @ref names
+   */
+  template <const auto &names, typename Writer, typename... Args>
+  static void dump(Writer &writer, const Args &...refs) {
+    using Fragments = detail::KeyFragments<names>;
+    static_assert(Fragments::size == sizeof...(Args),
+                  "Number of names and fields should be equal");
+
+    writer.start_object();
+    dump_members<names>(writer, std::index_sequence_for<Args...>{}, refs...);
+    writer.end_object();
+  }
+
+private:
+  template <const auto &names, typename Writer, size_t... indices,
+            typename... Args>
+  static void dump_members(Writer &writer, std::index_sequence<indices...>,
+                           const Args &...refs) {
+    (
+        [&]() {
+          if constexpr (detail::has_raw_key<Writer>::value) {
+            writer.raw_key(
+                detail::KeyFragments<names>::template get<indices>());
+          } else {
+            writer.key(names[indices]);
+          }
+          Serializer::dump<Args>(refs, writer);
+        }(),
+        ...);
+  }
 };
 } // namespace ctjson
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -7,6 +8,7 @@
 
 #include <ctjson/Serializable.hpp>
 
+#include <ctjson/detail/CountingWriter.hpp>
 #include <ctjson/detail/Typing.hpp>
 
 namespace ctjson {
@@ -21,7 +23,7 @@ public:
       writer.integer(value);
     } else if constexpr (std::is_floating_point_v<T>) {
       writer.floating(value);
-    } else if constexpr (std::is_same_v<T, std::string>) {
+    } else if constexpr (detail::is_string_v<T>) {
       writer.string(value);
     } else {
       static_assert(!sizeof(T), "Unexpected value type");
@@ -41,7 +43,8 @@ public:
   }
 
   template <typename T, typename Writer>
-  static inline std::enable_if_t<detail::is_array_like_v<T>>
+  static inline std::enable_if_t<detail::is_array_like_v<T> ||
+                                 detail::is_fixed_array_v<T>>
   dump(const T &value, Writer &writer) {
     using ValueType = typename T::value_type;
 
@@ -77,5 +80,19 @@ public:
   dump(const T &value, Writer &writer) {
     Serializable<T, Writer>::dump(value, writer);
   }
+
+  /**
+   * @brief Compute exact size of json written by dump with BufferWriter
+   *
+   * @param value value to measure
+   * @return size of json in bytes
+   */
+  template <typename T>
+  static inline size_t measure(const T &value) {
+    detail::CountingWriter writer;
+    dump(value, writer);
+
+    return writer.size();
+  }
 };
 }; // namespace ctjson
\ No newline at end of file
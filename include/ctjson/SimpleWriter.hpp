@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cmath>
+#include <string_view>
+
 #include <rapidjson/writer.h>
 
-#include <ctjson/detail/TypeUtils.hpp>
+#include <ctjson/detail/NumberFormat.hpp>
 
 namespace ctjson {
 
@@ -19,33 +22,28 @@ public:
 
   template <typename Int>
   void integer(Int value) {
-    if (value > 0) {
-      if (detail::in_range<unsigned>(value)) {
-        m_writer.Uint(value);
-      } else {
-        m_writer.Uint64(value);
-      }
-    } else {
-      if (detail::in_range<int>(value)) {
-        m_writer.Int(value);
-      } else {
-        m_writer.Int64(value);
-      }
-    }
+    char buffer[detail::max_integer_size<Int>()];
+    raw_number(buffer, detail::write_integer(buffer, value));
   }
 
   template <typename Floating>
   void floating(Floating value) {
-    m_writer.Double(value);
+    if (!std::isfinite(value)) {
+      null();
+      return;
+    }
+
+    char buffer[detail::max_floating_size<Floating>({})];
+    raw_number(buffer, detail::write_floating(buffer, value, {}));
   }
 
-  void string(const std::string &value) {
+  void string(std::string_view value) {
     m_writer.String(value.data(), value.length(), true);
   }
 
   void start_object() { m_writer.StartObject(); }
 
-  void key(const std::string &key) {
+  void key(std::string_view key) {
     m_writer.Key(key.data(), key.length(), true);
   }
 
@@ -56,6 +54,13 @@ public:
   void end_array() { m_writer.EndArray(); }
 
 private:
+  /**
+   * @brief Write formatted number [begin, end)
+   */
+  void raw_number(const char *begin, const char *end) {
+    m_writer.RawValue(begin, end - begin, rapidjson::kNumberType);
+  }
+
   rapidjson::Writer<OutputStream> m_writer;
 };
 } // namespace ctjson
\ No newline at end of file
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <rapidjson/error/en.h>
+#include <rapidjson/reader.h>
+
+#include <ctjson/TokenStream.hpp>
+
+#include <ctjson/detail/LazyPath.hpp>
+#include <ctjson/detail/Tape.hpp>
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson {
+
+/**
+ * @brief Token stream walking tape of whole json document
+ *
+ * Input is tokenized to detail::Tape in one pass on construction, then
+ * tokens are read from tape sequentially. Tokens reference strings stored in
+ * tape, so no strings are allocated before conversion to values, and
+ * containers are skipped without visiting their tokens. Tokens preceding
+ * json error are produced before the error is reported, as by TokenStream.
+ *
+ * std::string_view values parsed from this stream reference tape, so they
+ * are valid only while stream exists.
+ *
+ * Usage example:
+ * @code{.cpp}
+ * TapeTokenStream tokens(rapidjson::StringStream(json));
+ * auto result = Deserializer::parse<MyType>(tokens);
+ * @endcode
+ *
+ * @tparam InputStream type of input stream
+ */
+template <typename InputStream>
+class TapeTokenStream {
+public:
+  // Type of tokens produced by this stream
+  using token_type = detail::TokenView;
+
+public:
+  /**
+   * @param is input stream
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
+   */
+  explicit TapeTokenStream(
+      InputStream is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_resource(resource) {
+    detail::TapeBuilder builder(m_tape);
+    rapidjson::Reader reader;
+
+    const auto result = reader.Parse<flags>(is, builder);
+    if (result.IsError()) {
+      m_error = rapidjson::GetParseError_En(result.Code());
+    }
+  }
+
+  /**
+   * @return tokenized document
+   */
+  const detail::Tape &tape() const { return m_tape; }
+
+  /**
+   * @return true if stream encountered error, after all tokens preceding it
+   * are read
+   */
+  bool has_error() const { return m_error.has_value() && is_exhausted(); }
+
+  /**
+   * @return memory resource for parsed values
+   */
+  std::pmr::memory_resource *memory_resource() const { return m_resource; }
+
+  /**
+   * @return error description, with static storage
+   * @pre has_error() == true
+   */
+  std::string_view get_error() const { return m_error.value(); }
+
+  /**
+   * @return true if parsing is complete
+   */
+  bool is_complete() const { return !m_error.has_value() && is_exhausted(); }
+
+  /**
+   * @brief Peek next token
+   * @return   std::nullopt if there is no next token,
+   *           reference to next token otherwise
+   */
+  const std::optional<token_type> &peek() {
+    acquire_token();
+
+    return m_token;
+  }
+
+  /**
+   * @brief Retrieve next token
+   * @return   std::nullopt if there is no next token,
+   *           next token otherwise
+   */
+  std::optional<token_type> next() {
+    if (!acquire_token()) {
+      return std::nullopt;
+    }
+
+    std::optional<token_type> result = std::move(m_token);
+    m_token.reset();
+
+    return result;
+  }
+
+  /**
+   * @brief Skip next value, containers are skipped in one step
+   *
+   * Path is updated as for a single value.
+   * @return true if value was skipped, false on error or end of json
+   */
+  bool skip_value() {
+    if (m_token.has_value()) {
+      // Value is peeked, so its first token is already seen by on_advance
+      const auto t_type = m_tape.type(m_current);
+      m_token.reset();
+      if (t_type != detail::TokenType::StartObject &&
+          t_type != detail::TokenType::StartArray) {
+        return true;
+      }
+
+      m_position = m_tape.skip(m_current);
+      if (m_position == m_tape.size() && m_error.has_value()) {
+        return false;
+      }
+      if (t_type == detail::TokenType::StartObject) {
+        m_path.end_object();
+      } else {
+        m_path.end_array();
+      }
+
+      return true;
+    }
+
+    if (is_exhausted()) {
+      return false;
+    }
+
+    const auto t_type = m_tape.type(m_position);
+    if (t_type == detail::TokenType::EndObject ||
+        t_type == detail::TokenType::EndArray) {
+      // There is no value to skip, end token stays peeked
+      acquire_token();
+      return false;
+    }
+
+    m_position = m_tape.skip(m_position);
+    if (m_position == m_tape.size() && m_error.has_value()) {
+      return false;
+    }
+    m_path.value();
+
+    return true;
+  }
+
+  /**
+   * @return number of elements of array which start token was just
+   * retrieved, read from its end token, 0 if array is not complete or
+   * another token was retrieved
+   */
+  size_t size_hint() const {
+    if (m_token.has_value() || m_tape.empty() ||
+        m_tape.type(m_current) != detail::TokenType::StartArray) {
+      return 0;
+    }
+
+    const auto end = m_tape.payload(m_current);
+    return end == 0 ? 0 : m_tape.payload(end);
+  }
+
+  /**
+   * @brief Read run of numbers of array being read without producing tokens
+   *
+   * Each number is passed to @ref sink with the type of its token value.
+   * Reading stops before element which is not a number or is rejected by
+   * sink, so it is read by next() as usual.
+   *
+   * @param sink callable bool(V value), false leaves value unread
+   * @return number of elements read
+   * @pre next token is element or end of array
+   */
+  template <typename Sink>
+  size_t read_numbers(Sink &&sink) {
+    using Type = detail::TokenType;
+
+    size_t count = 0;
+    while (!m_token.has_value() && m_position < m_tape.size()) {
+      const auto payload = m_tape.payload(m_position);
+      bool is_accepted = false;
+      switch (m_tape.type(m_position)) {
+      case Type::Int:
+        is_accepted = sink(static_cast<int>(static_cast<uint32_t>(payload)));
+        break;
+      case Type::Uint:
+        is_accepted = sink(static_cast<unsigned>(payload));
+        break;
+      case Type::Int64:
+        is_accepted = sink(m_tape.value<int64_t>(m_position));
+        break;
+      case Type::Uint64:
+        is_accepted = sink(m_tape.value<uint64_t>(m_position));
+        break;
+      case Type::Double:
+        is_accepted = sink(m_tape.value<double>(m_position));
+        break;
+      default:
+        break;
+      }
+      if (!is_accepted) {
+        break;
+      }
+
+      m_current = m_position;
+      m_position = m_tape.next(m_current);
+      m_path.value();
+      ++count;
+    }
+
+    return count;
+  }
+
+  /**
+   * @brief Get current path in json
+   *
+   * @return always current path in json
+   */
+  std::optional<std::string> get_path() const {
+    return m_path.render([this](const size_t index) {
+      return std::string(m_tape.string(index));
+    });
+  }
+
+private:
+  /**
+   * @return true if all tokens are read
+   */
+  bool is_exhausted() const {
+    return m_position == m_tape.size() && !m_token.has_value();
+  }
+
+  /**
+   * @brief Make sure that there is next token or end reached or error
+   * encountered
+   */
+  bool acquire_token() {
+    if (!m_token.has_value() && m_position < m_tape.size()) {
+      m_current = m_position;
+      m_position = m_tape.next(m_current);
+      m_token = read_token(m_current);
+      on_advance(m_current);
+    }
+
+    return m_token.has_value();
+  }
+
+  /**
+   * @return token starting at word @ref index
+   */
+  token_type read_token(const size_t index) const {
+    using Type = detail::TokenType;
+
+    const auto payload = m_tape.payload(index);
+    switch (m_tape.type(index)) {
+    case Type::Null:
+      return token_type::create<Type::Null>();
+    case Type::Bool:
+      return token_type::create<Type::Bool>(payload != 0);
+    case Type::Int:
+      return token_type::create<Type::Int>(
+          static_cast<int>(static_cast<uint32_t>(payload)));
+    case Type::Uint:
+      return token_type::create<Type::Uint>(static_cast<unsigned>(payload));
+    case Type::Int64:
+      return token_type::create<Type::Int64>(m_tape.value<int64_t>(index));
+    case Type::Uint64:
+      return token_type::create<Type::Uint64>(m_tape.value<uint64_t>(index));
+    case Type::Double:
+      return token_type::create<Type::Double>(m_tape.value<double>(index));
+    case Type::RawNumber:
+      return token_type::create<Type::RawNumber>(m_tape.string(index));
+    case Type::String:
+      return token_type::create<Type::String>(m_tape.string(index));
+    case Type::StartObject:
+      return token_type::create<Type::StartObject>();
+    case Type::Key:
+      return token_type::create<Type::Key>(m_tape.string(index));
+    case Type::EndObject:
+      return token_type::create<Type::EndObject>(
+          static_cast<unsigned>(payload));
+    case Type::StartArray:
+      return token_type::create<Type::StartArray>();
+    case Type::EndArray:
+    default:
+      return token_type::create<Type::EndArray>(
+          static_cast<unsigned>(payload));
+    }
+  }
+
+  /**
+   * @brief Update path on new token at word @ref index
+   */
+  void on_advance(const size_t index) {
+    switch (m_tape.type(index)) {
+    case detail::TokenType::StartObject:
+      m_path.start_object();
+      break;
+    case detail::TokenType::Key:
+      m_path.key(index);
+      break;
+    case detail::TokenType::EndObject:
+      m_path.end_object();
+      break;
+    case detail::TokenType::StartArray:
+      m_path.start_array();
+      break;
+    case detail::TokenType::EndArray:
+      m_path.end_array();
+      break;
+    default:
+      m_path.value();
+      break;
+    }
+  }
+
+private:
+  // Parsing flags, content after root value is ignored as by TokenStream
+  constexpr static unsigned flags =
+      rapidjson::ParseFlag::kParseIterativeFlag |
+      rapidjson::ParseFlag::kParseStopWhenDoneFlag |
+      rapidjson::ParseFlag::kParseTrailingCommasFlag |
+      detail::StreamTraits<InputStream>::flags;
+
+  detail::Tape m_tape;
+  std::pmr::memory_resource *m_resource;
+  std::optional<std::string_view> m_error;
+
+  // Index of word of the next token
+  size_t m_position = 0;
+  // Index of word of current token
+  size_t m_current = 0;
+  std::optional<token_type> m_token = std::nullopt;
+
+  detail::LazyPath m_path;
+};
+
+} // namespace ctjson
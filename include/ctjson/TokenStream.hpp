@@ -1,13 +1,19 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 #include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/reader.h>
 
+#include <ctjson/detail/LazyPath.hpp>
 #include <ctjson/detail/Path.hpp>
 #include <ctjson/detail/Token.hpp>
 
@@ -15,10 +21,83 @@ namespace ctjson {
 
 namespace detail {
 
+/**
+ * @brief Traits of input stream, selecting token type and parsing flags
+ *
+ * Strings parsed from regular streams are copied to tokens
+ */
+template <typename InputStream>
+struct StreamTraits {
+  using token_type = Token;
+
+  constexpr static unsigned flags = 0;
+};
+
+/**
+ * @brief Specialization for in-situ streams
+ *
+ * Strings are decoded in place, so tokens could reference input buffer
+ */
+template <typename Encoding>
+struct StreamTraits<rapidjson::GenericInsituStringStream<Encoding>> {
+  using token_type = TokenView;
+
+  constexpr static unsigned flags = rapidjson::ParseFlag::kParseInsituFlag;
+};
+
+/**
+ * @brief Access to whole input of streams reading from memory
+ *
+ * Not defined for streams without random access
+ */
+template <typename InputStream>
+struct StreamBuffer;
+
+template <typename Encoding>
+struct StreamBuffer<rapidjson::GenericStringStream<Encoding>> {
+  // Strings in input are not decoded in place
+  constexpr static bool is_insitu = false;
+
+  static const char *begin(const rapidjson::GenericStringStream<Encoding> &is) {
+    return is.head_;
+  }
+};
+
+template <typename Encoding>
+struct StreamBuffer<rapidjson::GenericInsituStringStream<Encoding>> {
+  // Strings in input are decoded in place
+  constexpr static bool is_insitu = true;
+
+  static const char *
+  begin(const rapidjson::GenericInsituStringStream<Encoding> &is) {
+    return is.head_;
+  }
+};
+
+template <>
+struct StreamBuffer<rapidjson::MemoryStream> {
+  // Strings in input are not decoded in place
+  constexpr static bool is_insitu = false;
+
+  static const char *begin(const rapidjson::MemoryStream &is) {
+    return is.begin_;
+  }
+};
+
 /**
  * @brief Class implementing Handler concept from rapidjson to retrieve tokens
+ *
+ * Tokens are stored in ring buffer, so several tokens could be read ahead
+ *
+ * @tparam Token type of token to produce, @see BasicToken
+ * @tparam t_capacity maximal number of buffered tokens
  */
+template <typename Token, size_t t_capacity = 1>
 class TokenHandler {
+  static_assert(t_capacity > 0, "Token buffer could not be empty");
+
+  using StringType = typename Token::string_type;
+
 public:
   bool Null() { return dispatch<Token::Type::Null>(); }
   bool Bool(bool boolean) { return dispatch<Token::Type::Bool>(boolean); }
@@ -30,14 +109,14 @@ public:
   }
   bool Double(double number) { return dispatch<Token::Type::Double>(number); }
   bool RawNumber(const char *str, unsigned len, bool copy) {
-    return dispatch<Token::Type::RawNumber>(std::string(str, len));
+    return dispatch_string<Token::Type::RawNumber>(str, len);
   }
   bool String(const char *str, unsigned len, bool copy) {
-    return dispatch<Token::Type::String>(std::string(str, len));
+    return dispatch_string<Token::Type::String>(str, len);
   }
   bool StartObject() { return dispatch<Token::Type::StartObject>(); }
   bool Key(const char *str, unsigned len, bool copy) {
-    return dispatch<Token::Type::Key>(std::string(str, len));
+    return dispatch_string<Token::Type::Key>(str, len);
   }
   bool EndObject(unsigned size) {
     return dispatch<Token::Type::EndObject>(size);
@@ -46,18 +125,44 @@ public:
   bool EndArray(unsigned size) { return dispatch<Token::Type::EndArray>(size); }
 
   /**
-   * @return const reference to current token
+   * @param index index of buffered token, 0 is the first one
+   * @return const reference to buffered token, std::nullopt if there are
+   * not enough tokens
    */
-  const std::optional<Token> &peek() const { return m_token; }
+  const std::optional<Token> &peek(const size_t index = 0) const {
+    if (index >= m_size) {
+      return m_end;
+    }
+
+    return m_tokens[(m_head + index) % t_capacity];
+  }
 
   /**
-   * @return current token
+   * @return offset in input after buffered token, @see set_offset
+   * @pre index < size()
+   */
+  size_t offset(const size_t index = 0) const {
+    return m_offsets[(m_head + index) % t_capacity];
+  }
+
+  /**
+   * @brief Record offset in input after the last buffered token
+   */
+  void set_offset(const size_t offset) {
+    m_offsets[(m_head + m_size - 1) % t_capacity] = offset;
+  }
+
+  /**
+   * @return the first buffered token
    * @pre has_token() == true
-   * @post has_token() == false
+   * @post the token is removed from buffer
    */
   Token token() {
-    Token result = std::move(m_token.value());
-    m_token.reset();
+    auto &slot = m_tokens[m_head];
+    Token result = std::move(slot.value());
+    slot.reset();
+    m_head = (m_head + 1) % t_capacity;
+    --m_size;
 
     return result;
   }
@@ -65,62 +170,183 @@ public:
   /**
    * @return true if this handler has token
    */
-  bool has_token() const { return m_token.has_value(); }
+  bool has_token() const { return m_size > 0; }
+
+  /**
+   * @return number of buffered tokens
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * @return true if no more tokens could be buffered
+   */
+  bool is_full() const { return m_size == t_capacity; }
+
+  /**
+   * @brief Start skipping events of one value, no tokens are produced
+   *
+   * @param depth nesting depth already entered in skipped value
+   * @pre has_token() == false
+   */
+  void skip(size_t depth) {
+    m_skip_depth = depth;
+    m_skipping = true;
+  }
+
+  /**
+   * @return true if skipped value is not complete yet
+   */
+  bool is_skipping() const { return m_skipping; }
+
+  /**
+   * @brief Drop buffered tokens and skipping state
+   */
+  void reset() {
+    while (has_token()) {
+      token();
+    }
+    m_head = 0;
+    m_skipping = false;
+    m_skip_depth = 0;
+  }
 
 private:
   /**
-   * @brief emplace current token
+   * @brief emplace token at the end of buffer
    *
    * @tparam t_type type of token to emplace
    * @tparam Args types of arguments to Token::create
    * @param args arguments to Token::create
    * @return true
    */
-  template <Token::Type t_type, typename... Args>
+  template <TokenType t_type, typename... Args>
   bool dispatch(Args &&...args) {
-    m_token = Token::create<t_type>(args...);
+    if (m_skipping) {
+      return skip_event<t_type>();
+    }
+
+    m_tokens[(m_head + m_size) % t_capacity] =
+        Token::template create<t_type>(args...);
+    ++m_size;
+    return true;
+  }
+
+  /**
+   * @brief emplace token holding string, string is not constructed while
+   * skipping
+   */
+  template <TokenType t_type>
+  bool dispatch_string(const char *str, unsigned len) {
+    if (m_skipping) {
+      return skip_event<t_type>();
+    }
+
+    return dispatch<t_type>(StringType(str, len));
+  }
+
+  /**
+   * @brief track nesting depth of skipped value
+   *
+   * @return true
+   */
+  template <TokenType t_type>
+  bool skip_event() {
+    if constexpr (t_type == TokenType::StartObject ||
+                  t_type == TokenType::StartArray) {
+      ++m_skip_depth;
+    } else if constexpr (t_type == TokenType::EndObject ||
+                         t_type == TokenType::EndArray) {
+      --m_skip_depth;
+    }
+    m_skipping = m_skip_depth > 0;
+
     return true;
   }
 
 private:
-  std::optional<Token> m_token = std::nullopt;
+  std::array<std::optional<Token>, t_capacity> m_tokens;
+  std::array<size_t, t_capacity> m_offsets = {};
+  // Index of the first buffered token
+  size_t m_head = 0;
+  size_t m_size = 0;
+
+  const std::optional<Token> m_end = std::nullopt;
+
+  bool m_skipping = false;
+  size_t m_skip_depth = 0;
 };
 } // namespace detail
 
+// Default number of tokens read ahead by token streams
+constexpr size_t default_lookahead = 8;
+
 /**
  * @brief Class converting input stream to token stream
  *
+ * Tokens are read from input in batches of up to @ref t_lookahead tokens,
+ * which amortizes reader calls and allows looking several tokens ahead,
+ * @see peek
+ *
  * @tparam InputStream type of input stream
- * @tparam Derived derived class for crtp, @see advance
+ * @tparam Derived derived class for crtp, @see acquire_token
+ * @tparam t_lookahead maximal number of tokens read ahead
  */
-template <typename InputStream, typename Derived = void>
+template <typename InputStream, typename Derived = void,
+          size_t t_lookahead = default_lookahead>
 class TokenStream {
+  using Traits = detail::StreamTraits<InputStream>;
+
+public:
+  // Type of tokens produced by this stream
+  using token_type = typename Traits::token_type;
+
+  // Maximal number of tokens read ahead
+  constexpr static size_t lookahead = t_lookahead;
 
 public:
   /**
    * @param is input stream
+   * @param resource memory resource for parsed values with polymorphic
+   * allocators (std::pmr containers and strings)
    */
-  TokenStream(InputStream is) : m_is(std::move(is)) {
+  TokenStream(
+      InputStream is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : m_is(std::move(is)), m_resource(resource) {
     m_reader.IterativeParseInit();
   }
 
   /**
-   * @return true if stream encountered error
+   * @return true if stream encountered error, after all tokens preceding it
+   * are read
    */
-  bool has_error() const { return m_error.has_value(); }
+  bool has_error() const {
+    return m_error.has_value() && !m_handler.has_token();
+  }
 
   /**
-   * @return error
+   * @return memory resource for parsed values
+   */
+  std::pmr::memory_resource *memory_resource() const { return m_resource; }
+
+  /**
+   * @return error description, with static storage
    * @pre has_error() == true
    */
-  std::string get_error() const { return m_error.value(); }
+  std::string_view get_error() const { return m_error.value(); }
+
+  /**
+   * @return offset in input after the last retrieved token, or of error if
+   * stream encountered it
+   */
+  size_t get_offset() const { return has_error() ? m_error_offset : m_offset; }
 
   /**
    * @return true if parsing is complete
    */
   bool is_complete() const {
     return m_reader.IterativeParseComplete() &&
-           !m_handler.has_token(); // We could have one more token after peek
+           !m_handler.has_token(); // We could have more tokens read ahead
   }
 
   /**
@@ -128,25 +354,152 @@ public:
    * @return   std::nullopt if there is no next token,
    *           reference to next token otherwise
    */
-  const std::optional<detail::Token> &peek() {
+  const std::optional<token_type> &peek() {
     acquire_token();
 
     return m_handler.peek();
   }
 
+  /**
+   * @brief Peek token further ahead, path is not updated for it
+   *
+   * @param index index of token, peek(0) is the same as peek()
+   * @return   std::nullopt if there is no such token or @ref index is not
+   *           less than lookahead, reference to token otherwise
+   */
+  const std::optional<token_type> &peek(const size_t index) {
+    if (!acquire_token()) {
+      return m_handler.peek();
+    }
+    if (m_handler.size() <= index && index < t_lookahead) {
+      fill(index + 1);
+    }
+
+    return m_handler.peek(index);
+  }
+
   /**
    * @brief Retrieve next token
    * @return   std::nullopt if there is no next token,
    *           next token otherwise
    */
-  std::optional<detail::Token> next() {
+  std::optional<token_type> next() {
     if (acquire_token()) {
+      m_advanced = false;
+      m_offset = m_handler.offset();
       return m_handler.token();
     } else {
       return std::nullopt;
     }
   }
 
+  /**
+   * @brief Skip next value without producing tokens
+   *
+   * Tokens already read ahead are dropped, for the rest of value only
+   * nesting depth is tracked, so no strings are constructed and path is
+   * updated as for a single value. Strings of tokens read ahead are already
+   * constructed, so with owning tokens lookahead of 1 skips with the least
+   * allocations.
+   * @return true if value was skipped, false on error or end of json
+   */
+  bool skip_value() {
+    if (has_error() || is_complete()) {
+      return false;
+    }
+
+    // Value is peeked, so its first token is already seen by on_advance
+    const bool peeked = m_advanced;
+    m_advanced = false;
+    std::optional<token_type> end = std::nullopt;
+    size_t depth = 0;
+    bool complete = false;
+    size_t offset = 0;
+    while (!complete && m_handler.has_token()) {
+      const auto &token = m_handler.peek().value();
+      // End token is reported for the outermost container only
+      if (token.template is_of_type<detail::Token::Type::StartObject>()) {
+        if (depth == 0) {
+          end =
+              token_type::template create<detail::Token::Type::EndObject>(0u);
+        }
+        ++depth;
+      } else if (token.template is_of_type<
+                     detail::Token::Type::StartArray>()) {
+        if (depth == 0) {
+          end = token_type::template create<detail::Token::Type::EndArray>(0u);
+        }
+        ++depth;
+      } else if (token.template is_of_type<detail::Token::Type::EndObject>() ||
+                 token.template is_of_type<detail::Token::Type::EndArray>()) {
+        if (depth == 0) {
+          // There is no value to skip
+          m_advanced = peeked;
+          return false;
+        }
+        --depth;
+      }
+
+      offset = m_handler.offset();
+      m_handler.token();
+      complete = depth == 0;
+    }
+
+    if (!complete) {
+      // Rest of value is not read yet
+      m_handler.skip(depth);
+      m_started = true;
+      do {
+        if (!m_reader.IterativeParseNext<flags>(m_is, m_handler)) {
+          handle_parse_error(m_reader.GetParseErrorCode());
+          return false;
+        }
+      } while (m_handler.is_skipping());
+      offset = m_is.Tell();
+    }
+    m_offset = offset;
+
+    if constexpr (!std::is_same_v<Derived, void>) {
+      if (peeked && end) {
+        static_cast<Derived *>(this)->on_advance(end.value(), offset);
+      } else if (!peeked) {
+        static_cast<Derived *>(this)->on_skip(offset);
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Start next document of multi-document input: concatenated or
+   * newline-delimited json
+   *
+   * Should be called before each document, including the first one. Reader
+   * and its internal stack are reused between documents. If current document
+   * is not complete (e.g. on error), input is skipped up to the next line.
+   * @return true if there is next document, false on end of input
+   */
+  bool next_document() {
+    if (m_started &&
+        (m_error.has_value() || !m_reader.IterativeParseComplete())) {
+      // Resynchronize on the next line
+      while (m_is.Peek() != '\0' && m_is.Take() != '\n') {
+      }
+    }
+
+    m_started = false;
+    m_advanced = false;
+    m_error.reset();
+    m_handler.reset();
+    m_reader.IterativeParseInit();
+    rapidjson::SkipWhitespace(m_is);
+    if constexpr (!std::is_same_v<Derived, void>) {
+      static_cast<Derived *>(this)->on_reset();
+    }
+
+    return m_is.Peek() != '\0';
+  }
+
   /**
    * @brief Get current path in json
    *
@@ -157,32 +510,51 @@ public:
 
 protected:
   /**
-   * @brief Make sure that handler has next token or end reached or error
-   * encountered;
+   * @return input stream
+   */
+  InputStream &input_stream() { return m_is; }
+  const InputStream &input_stream() const { return m_is; }
+
+  /**
+   * @brief Make sure that there is next token or end reached or error
+   * encountered, path is updated on the first access to token
    */
   bool acquire_token() {
-    if (has_error() || is_complete()) {
+    if (!m_handler.has_token()) {
+      fill(t_lookahead);
+    }
+    if (!m_handler.has_token()) {
       return false;
     }
 
-    if (!m_handler.has_token()) {
-      advance();
+    if constexpr (!std::is_same_v<Derived, void>) {
+      if (!m_advanced) {
+        static_cast<Derived *>(this)->on_advance(m_handler.peek().value(),
+                                                 m_handler.offset());
+      }
     }
+    m_advanced = true;
 
-    return m_handler.has_token();
+    return true;
   }
 
   /**
-   * @brief Advance one token further
+   * @brief Read tokens ahead until there are @ref count of them, end
+   * reached or error encountered
    */
-  void advance() {
-    const auto result = m_reader.IterativeParseNext<flags>(m_is, m_handler);
-    if (!result) {
-      handle_parse_error(m_reader.GetParseErrorCode());
-    } else if (!m_handler.has_token()) {
-      m_error = "Unexpected state: no token acquired, possibly a bug";
-    } else if constexpr (!std::is_same_v<Derived, void>) {
-      static_cast<Derived *>(this)->on_advance(m_handler.peek().value());
+  void fill(const size_t count) {
+    while (m_handler.size() < count && !m_error.has_value() &&
+           !m_reader.IterativeParseComplete()) {
+      m_started = true;
+      const size_t size = m_handler.size();
+      if (!m_reader.IterativeParseNext<flags>(m_is, m_handler)) {
+        handle_parse_error(m_reader.GetParseErrorCode());
+      } else if (m_handler.size() == size) {
+        m_error = "Unexpected state: no token acquired, possibly a bug";
+        m_error_offset = m_is.Tell();
+      } else {
+        m_handler.set_offset(m_is.Tell());
+      }
     }
   }
 
@@ -190,43 +562,64 @@ protected:
    * @brief Set error based on parse error code
    */
   void handle_parse_error(rapidjson::ParseErrorCode code) {
-    std::string error = rapidjson::GetParseError_En(code);
     if (code == rapidjson::ParseErrorCode::kParseErrorTermination ||
         code == rapidjson::ParseErrorCode::kParseErrorNone) {
-      error = "Unexpected error: " + error + ", possibly a bug";
+      m_error = "Unexpected error of reader, possibly a bug";
+    } else {
+      m_error = rapidjson::GetParseError_En(code);
     }
-    m_error = std::move(error);
+    m_error_offset = m_reader.GetErrorOffset();
   }
 
 private:
-  // Parsing flags
+  // Parsing flags, parsing stops after each document, @see next_document
   constexpr static unsigned flags =
       rapidjson::ParseFlag::kParseIterativeFlag |
-      rapidjson::ParseFlag::kParseTrailingCommasFlag;
+      rapidjson::ParseFlag::kParseStopWhenDoneFlag |
+      rapidjson::ParseFlag::kParseTrailingCommasFlag | Traits::flags;
 
   InputStream m_is;
   rapidjson::Reader m_reader;
-  detail::TokenHandler m_handler;
+  detail::TokenHandler<token_type, t_lookahead> m_handler;
+  std::pmr::memory_resource *m_resource;
+
+  // Current document is started
+  bool m_started = false;
+  // The first buffered token is seen by on_advance
+  bool m_advanced = false;
+
+  // Offset in input after the last retrieved token
+  size_t m_offset = 0;
 
-  std::optional<std::string> m_error;
+  std::optional<std::string_view> m_error;
+  size_t m_error_offset = 0;
 };
 
 /**
  * @brief Class to convert input stream to token stream maintaining path in json
  *
  * @tparam InputStream type of input stream
+ * @tparam t_lookahead maximal number of tokens read ahead
  */
-template <typename InputStream>
+template <typename InputStream, size_t t_lookahead = default_lookahead>
 class ContextTokenStream
-    : public TokenStream<InputStream, ContextTokenStream<InputStream>> {
-  using Base = TokenStream<InputStream, ContextTokenStream<InputStream>>;
+    : public TokenStream<InputStream,
+                         ContextTokenStream<InputStream, t_lookahead>,
+                         t_lookahead> {
+  using Base =
+      TokenStream<InputStream, ContextTokenStream<InputStream, t_lookahead>,
+                  t_lookahead>;
   friend Base;
 
 public:
   /**
    * @param is input stream
+   * @param resource memory resource for parsed values
    */
-  ContextTokenStream(InputStream is) : Base(std::move(is)) {}
+  ContextTokenStream(
+      InputStream is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : Base(std::move(is), resource) {}
 
   /**
    * @brief Get current path in json
@@ -239,23 +632,155 @@ private:
   /**
    * @brief Update path on new token
    */
-  void on_advance(const detail::Token &token) {
-    if (token.is_of_type<detail::Token::Type::StartObject>()) {
+  void on_advance(const typename Base::token_type &token, size_t) {
+    if (token.template is_of_type<detail::Token::Type::StartObject>()) {
       m_path.start_object();
-    } else if (token.is_of_type<detail::Token::Type::Key>()) {
-      m_path.key(token.value<detail::Token::Type::Key>());
-    } else if (token.is_of_type<detail::Token::Type::EndObject>()) {
+    } else if (token.template is_of_type<detail::Token::Type::Key>()) {
+      m_path.key(token.template value<detail::Token::Type::Key>());
+    } else if (token.template is_of_type<detail::Token::Type::EndObject>()) {
       m_path.end_object();
-    } else if (token.is_of_type<detail::Token::Type::StartArray>()) {
+    } else if (token.template is_of_type<detail::Token::Type::StartArray>()) {
       m_path.start_array();
-    } else if (token.is_of_type<detail::Token::Type::EndArray>()) {
+    } else if (token.template is_of_type<detail::Token::Type::EndArray>()) {
       m_path.end_array();
     } else {
       m_path.value();
     }
   }
 
+  /**
+   * @brief Update path on skipped value
+   */
+  void on_skip(size_t) { m_path.value(); }
+
+  /**
+   * @brief Reset path on new document
+   */
+  void on_reset() { m_path = detail::Path(); }
+
 private:
   detail::Path m_path;
 };
+
+/**
+ * @brief Class to convert input stream to token stream maintaining path in
+ * json lazily
+ *
+ * Only positions are recorded while parsing, keys are read back from input
+ * when path is requested, so successful parsing does not pay for rendering
+ * path. Input stream should read from memory, @see detail::StreamBuffer
+ *
+ * @tparam InputStream type of input stream
+ * @tparam t_lookahead maximal number of tokens read ahead
+ */
+template <typename InputStream, size_t t_lookahead = default_lookahead>
+class LazyContextTokenStream
+    : public TokenStream<InputStream,
+                         LazyContextTokenStream<InputStream, t_lookahead>,
+                         t_lookahead> {
+  using Base = TokenStream<InputStream,
+                           LazyContextTokenStream<InputStream, t_lookahead>,
+                           t_lookahead>;
+  using Buffer = detail::StreamBuffer<InputStream>;
+  friend Base;
+
+public:
+  /**
+   * @param is input stream
+   * @param resource memory resource for parsed values
+   */
+  LazyContextTokenStream(
+      InputStream is,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : Base(std::move(is), resource) {}
+
+  /**
+   * @brief Get current path in json
+   *
+   * @return always current path in json
+   */
+  std::optional<std::string> get_path() const {
+    return m_path.render(
+        [this](const size_t offset) { return read_key(offset); });
+  }
+
+private:
+  /**
+   * @brief Update path on new token
+   *
+   * @param offset offset in input after token
+   */
+  void on_advance(const typename Base::token_type &token,
+                  const size_t offset) {
+    if (token.template is_of_type<detail::Token::Type::StartObject>()) {
+      m_path.start_object();
+    } else if (token.template is_of_type<detail::Token::Type::Key>()) {
+      m_path.key(m_offset);
+    } else if (token.template is_of_type<detail::Token::Type::EndObject>()) {
+      m_path.end_object();
+    } else if (token.template is_of_type<detail::Token::Type::StartArray>()) {
+      m_path.start_array();
+    } else if (token.template is_of_type<detail::Token::Type::EndArray>()) {
+      m_path.end_array();
+    } else {
+      m_path.value();
+    }
+
+    m_offset = offset;
+  }
+
+  /**
+   * @brief Update path on skipped value
+   *
+   * @param offset offset in input after value
+   */
+  void on_skip(const size_t offset) {
+    m_path.value();
+    m_offset = offset;
+  }
+
+  /**
+   * @brief Reset path on new document
+   */
+  void on_reset() {
+    m_path = detail::LazyPath();
+    m_offset = Base::input_stream().Tell();
+  }
+
+  /**
+   * @brief Read key back from input
+   *
+   * @param offset offset of the end of token preceding key
+   * @return decoded key
+   */
+  std::string read_key(const size_t offset) const {
+    const char *begin = Buffer::begin(Base::input_stream()) + offset;
+    while (*begin != '"') {
+      ++begin;
+    }
+
+    if constexpr (Buffer::is_insitu) {
+      // Key is already decoded in place and null-terminated
+      return std::string(begin + 1);
+    } else {
+      rapidjson::StringStream ss(begin);
+      rapidjson::Reader reader;
+      detail::TokenHandler<detail::Token> handler;
+
+      reader.IterativeParseInit();
+      reader.IterativeParseNext<rapidjson::ParseFlag::kParseDefaultFlags>(
+          ss, handler);
+      if (!handler.has_token()) {
+        return {};
+      }
+
+      return handler.token().template value<detail::Token::Type::String>();
+    }
+  }
+
+private:
+  detail::LazyPath m_path;
+  // Offset in input of the end of last token
+  size_t m_offset = 0;
+};
 } // namespace ctjson
\ No newline at end of file
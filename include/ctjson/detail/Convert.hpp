@@ -0,0 +1,99 @@
+#pragma once
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <ctjson/detail/TypeUtils.hpp>
+#include <ctjson/detail/Typing.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Result of value conversion
+ */
+enum class Conversion {
+  Ok,
+  OutOfRange, // Integer value does not fit target type
+  Mismatch,   // Value type is not convertible to target type
+};
+
+/**
+ * @brief Kind of conversion of json value of type @tparam V to @tparam T
+ */
+template <typename T, typename V>
+struct ConversionKind {
+  constexpr static bool t_is_bool = std::is_same_v<T, bool>;
+  constexpr static bool v_is_bool = std::is_same_v<V, bool>;
+  constexpr static bool t_is_integer =
+      !t_is_bool && std::numeric_limits<T>::is_integer;
+  constexpr static bool v_is_integer =
+      !v_is_bool && std::numeric_limits<V>::is_integer;
+  constexpr static bool t_is_floating = std::is_floating_point_v<T>;
+  constexpr static bool v_is_floating = std::is_floating_point_v<V>;
+
+  constexpr static bool is_bool = t_is_bool && v_is_bool;
+  constexpr static bool is_integer = t_is_integer && v_is_integer;
+  constexpr static bool is_floating =
+      (v_is_integer || v_is_floating) && t_is_floating;
+  // Owned string is moved, view is materialized only if T owns string
+  constexpr static bool is_string = is_string_v<V> && is_string_v<T>;
+};
+
+/**
+ * @brief Is json value of type @tparam V convertible to @tparam T, otherwise
+ * convert_value always returns Conversion::Mismatch
+ */
+template <typename T, typename V>
+constexpr bool is_convertible_v =
+    ConversionKind<T, V>::is_bool || ConversionKind<T, V>::is_integer ||
+    ConversionKind<T, V>::is_floating || ConversionKind<T, V>::is_string;
+
+/**
+ * @brief Convert json value held by token to target type
+ *
+ * @tparam T target type
+ * @tparam V type of token value
+ * @param target reference to store result
+ * @param value token value
+ * @return conversion result
+ * @post if result is Conversion::Ok, @ref target holds converted value
+ */
+template <typename T, typename V>
+inline Conversion convert_value(T &target, V &&value) {
+  using ValueType = std::decay_t<V>;
+  using Kind = ConversionKind<T, ValueType>;
+
+  if constexpr (Kind::is_bool) {
+    target = value;
+  } else if constexpr (Kind::is_integer) {
+    if (!in_range<T>(value)) {
+      return Conversion::OutOfRange;
+    }
+    target = static_cast<T>(value);
+  } else if constexpr (Kind::is_floating) {
+    target = static_cast<T>(value);
+  } else if constexpr (Kind::is_string) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      target = std::forward<V>(value);
+    } else if constexpr (std::is_same_v<T, ValueType>) {
+      // Keep capacity of target if possible, otherwise take value buffer
+      if (target.capacity() >= value.size()) {
+        target.assign(value.data(), value.size());
+      } else {
+        target = std::forward<V>(value);
+      }
+    } else {
+      // Reuses target capacity and keeps its allocator
+      target.assign(value.data(), value.size());
+    }
+  } else {
+    return Conversion::Mismatch;
+  }
+
+  return Conversion::Ok;
+}
+
+} // namespace ctjson::detail
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include <ctjson/detail/Escape.hpp>
+#include <ctjson/detail/NumberFormat.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Writer counting size of json written by BufferWriter, without
+ * writing it
+ *
+ * Numbers are formatted the same way as by BufferWriter with default float
+ * format.
+ */
+class CountingWriter {
+public:
+  /**
+   * @return size of written json
+   */
+  size_t size() const { return m_size; }
+
+  void null() {
+    value_prefix();
+    m_size += 4;
+  }
+
+  void boolean(bool value) {
+    value_prefix();
+    m_size += value ? 4 : 5;
+  }
+
+  template <typename Int>
+  void integer(Int value) {
+    value_prefix();
+    using UInt = std::make_unsigned_t<Int>;
+    UInt magnitude = static_cast<UInt>(value);
+    if constexpr (std::is_signed_v<Int>) {
+      if (value < 0) {
+        ++m_size;
+        magnitude = static_cast<UInt>(0) - magnitude;
+      }
+    }
+    m_size += count_digits(magnitude);
+  }
+
+  template <typename Floating>
+  void floating(Floating value) {
+    if (!std::isfinite(value)) {
+      null();
+      return;
+    }
+
+    value_prefix();
+    char buffer[max_floating_size<Floating>({})];
+    m_size += write_floating(buffer, value, {}) - buffer;
+  }
+
+  void string(std::string_view value) {
+    value_prefix();
+    m_size += escaped_size(value);
+  }
+
+  void start_object() { start(); }
+
+  void key(std::string_view key) {
+    value_prefix();
+    m_size += escaped_size(key) + 1;
+    m_need_comma = false;
+  }
+
+  void raw_key(std::string_view fragment) {
+    m_size += fragment.size();
+    m_need_comma = false;
+  }
+
+  void end_object() { end(); }
+
+  void start_array() { start(); }
+
+  void end_array() { end(); }
+
+private:
+  void value_prefix() {
+    if (m_need_comma) {
+      ++m_size;
+    }
+    m_need_comma = true;
+  }
+
+  void start() {
+    value_prefix();
+    ++m_size;
+    m_need_comma = false;
+  }
+
+  void end() {
+    ++m_size;
+    m_need_comma = true;
+  }
+
+  size_t m_size = 0;
+  bool m_need_comma = false;
+};
+
+} // namespace ctjson::detail
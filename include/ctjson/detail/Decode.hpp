@@ -0,0 +1,455 @@
+#pragma once
+
+#include <charconv>
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <rapidjson/error/error.h>
+
+#include <ctjson/detail/StringScan.hpp>
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @return true if byte can not continue number or literal: whitespace,
+ * brace, bracket, colon, comma or quote
+ */
+constexpr bool is_scalar_end(const char c) {
+  switch (c) {
+  case ' ':
+  case '\t':
+  case '\n':
+  case '\r':
+  case '{':
+  case '}':
+  case '[':
+  case ']':
+  case ':':
+  case ',':
+  case '"':
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @return value of hex digit, -1 if @ref c is not hex digit
+ */
+constexpr int hex_digit(const char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+
+  return -1;
+}
+
+/**
+ * @brief Append code point encoded in UTF-8
+ */
+inline void append_utf8(std::string &out, const unsigned code_point) {
+  if (code_point < 0x80) {
+    out += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    out += static_cast<char>(0xC0 | (code_point >> 6));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    out += static_cast<char>(0xE0 | (code_point >> 12));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (code_point >> 18));
+    out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+}
+
+/**
+ * @brief Read 4 hex digits of \\u escape
+ *
+ * @return false if there are no 4 hex digits at @ref offset
+ */
+inline bool read_hex4(const std::string_view json, const size_t offset,
+                      unsigned &value) {
+  if (offset + 4 > json.size()) {
+    return false;
+  }
+
+  value = 0;
+  for (size_t i = offset; i < offset + 4; ++i) {
+    const int digit = hex_digit(json[i]);
+    if (digit < 0) {
+      return false;
+    }
+    value = value << 4 | static_cast<unsigned>(digit);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Decode json string, runs of bytes without escapes are copied at
+ * once, @see find_special
+ *
+ * Errors are the same as reported by rapidjson reader without encoding
+ * validation.
+ * @param json input
+ * @param begin offset of opening quote
+ * @param out decoded string is appended to it
+ * @return kParseErrorNone on success, error code otherwise
+ */
+inline rapidjson::ParseErrorCode
+decode_string(const std::string_view json, const size_t begin,
+              std::string &out) {
+  size_t i = begin + 1;
+  for (;;) {
+    const size_t run = find_special(json.data() + i, json.size() - i, false);
+    out.append(json.data() + i, run);
+    i += run;
+    if (i == json.size()) {
+      return rapidjson::kParseErrorStringMissQuotationMark;
+    }
+
+    const char c = json[i];
+    if (c == '"') {
+      return rapidjson::kParseErrorNone;
+    } else if (c != '\\') {
+      return c == '\0' ? rapidjson::kParseErrorStringMissQuotationMark
+                       : rapidjson::kParseErrorStringInvalidEncoding;
+    }
+
+    if (i + 1 == json.size()) {
+      return rapidjson::kParseErrorStringMissQuotationMark;
+    }
+    const char escape = json[i + 1];
+    i += 2;
+    switch (escape) {
+    case '"':
+    case '\\':
+    case '/':
+      out += escape;
+      break;
+    case 'b':
+      out += '\b';
+      break;
+    case 'f':
+      out += '\f';
+      break;
+    case 'n':
+      out += '\n';
+      break;
+    case 'r':
+      out += '\r';
+      break;
+    case 't':
+      out += '\t';
+      break;
+    case 'u': {
+      unsigned code_point = 0;
+      if (!read_hex4(json, i, code_point)) {
+        return rapidjson::kParseErrorStringUnicodeEscapeInvalidHex;
+      }
+      i += 4;
+      if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+        // High surrogate is followed by escaped low surrogate
+        unsigned low = 0;
+        if (i + 2 > json.size() || json[i] != '\\' || json[i + 1] != 'u') {
+          return rapidjson::kParseErrorStringUnicodeSurrogateInvalid;
+        }
+        if (!read_hex4(json, i + 2, low)) {
+          return rapidjson::kParseErrorStringUnicodeEscapeInvalidHex;
+        }
+        if (low < 0xDC00 || low > 0xDFFF) {
+          return rapidjson::kParseErrorStringUnicodeSurrogateInvalid;
+        }
+        i += 6;
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+      } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+        return rapidjson::kParseErrorStringUnicodeSurrogateInvalid;
+      }
+      append_utf8(out, code_point);
+      break;
+    }
+    default:
+      return rapidjson::kParseErrorStringEscapeInvalid;
+    }
+  }
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CTJSON_SWAR_DIGITS
+#endif
+
+#if defined(CTJSON_SWAR_DIGITS)
+/**
+ * @return 8 bytes of @ref data as little-endian word
+ */
+inline uint64_t load_eight(const char *data) {
+  uint64_t chunk;
+  std::memcpy(&chunk, data, sizeof(chunk));
+
+  return chunk;
+}
+
+/**
+ * @return true if all 8 bytes of @ref chunk are decimal digits
+ */
+constexpr bool is_eight_digits(const uint64_t chunk) {
+  // High nibble of digit is 3, adding 6 to its low nibble does not carry
+  return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+          (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+/**
+ * @brief Convert 8 decimal digits at once, combining pairs, then quads, then
+ * halves of word by multiplication
+ *
+ * @pre is_eight_digits(chunk)
+ */
+constexpr uint32_t parse_eight_digits(uint64_t chunk) {
+  constexpr uint64_t mask = 0x000000FF000000FF;
+  constexpr uint64_t mul1 = 100 + (uint64_t{1000000} << 32);
+  constexpr uint64_t mul2 = 1 + (uint64_t{10000} << 32);
+
+  chunk -= 0x3030303030303030;
+  chunk = chunk * 10 + (chunk >> 8);
+  chunk = ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32;
+
+  return static_cast<uint32_t>(chunk);
+}
+#endif
+
+/**
+ * @brief Parse json number with strtod, independent of current locale
+ *
+ * Used where floating point std::from_chars is not available and for
+ * values out of its range
+ *
+ * @param number valid json number
+ * @return parsed value, infinity on overflow
+ */
+inline double parse_double(const std::string_view number) {
+  // Number is copied to be null-terminated, usually on stack
+  char stack[64];
+  std::string heap;
+  char *buffer = stack;
+  if (number.size() < sizeof(stack)) {
+    std::memcpy(stack, number.data(), number.size());
+    stack[number.size()] = '\0';
+  } else {
+    heap.assign(number);
+    buffer = heap.data();
+  }
+
+  // strtod expects decimal point of current locale
+  if (char *point = std::strchr(buffer, '.')) {
+    *point = *std::localeconv()->decimal_point;
+  }
+
+  return std::strtod(buffer, nullptr);
+}
+
+/**
+ * @brief Parse number, passing its value to @ref visitor with the same type
+ * as of token produced by rapidjson reader: unsigned or int if value fits 32
+ * bits, uint64_t or int64_t if it fits 64 bits, double for other integers and
+ * numbers with fraction or exponent
+ *
+ * Digits are read 8 at a time where input allows, @see parse_eight_digits.
+ * @param json input
+ * @param offset offset of first byte of number, updated to offset past it
+ * @param visitor callable bool(V value), returning false stops parsing
+ * @return kParseErrorNone on success, kParseErrorTermination if visitor
+ * returned false, error code otherwise
+ */
+template <typename Visitor>
+inline rapidjson::ParseErrorCode visit_number(const std::string_view json,
+                                              size_t &offset,
+                                              Visitor &&visitor) {
+  const auto is_digit = [json](const size_t i) {
+    return i < json.size() && json[i] >= '0' && json[i] <= '9';
+  };
+  // Skip digits, 8 at a time where input allows
+  const auto skip_digits = [json, &is_digit](size_t i) {
+#if defined(CTJSON_SWAR_DIGITS)
+    while (i + 8 <= json.size() && is_eight_digits(load_eight(&json[i]))) {
+      i += 8;
+    }
+#endif
+    while (is_digit(i)) {
+      ++i;
+    }
+    return i;
+  };
+
+  const size_t begin = offset;
+  size_t i = offset;
+  const bool minus = json[i] == '-';
+  if (minus) {
+    ++i;
+  }
+  if (!is_digit(i)) {
+    return rapidjson::kParseErrorValueInvalid;
+  }
+
+  // Integers with larger magnitude are parsed as double
+  const uint64_t limit = minus ? uint64_t{1} << 63
+                               : std::numeric_limits<uint64_t>::max();
+  uint64_t magnitude = 0;
+  bool is_integer = true;
+  if (json[i] == '0') {
+    ++i;
+  } else {
+#if defined(CTJSON_SWAR_DIGITS)
+    // Magnitude times 10^8 plus 8 digits is below both limits
+    constexpr uint64_t swar_limit = 92233720367;
+    while (i + 8 <= json.size() && magnitude <= swar_limit) {
+      const uint64_t chunk = load_eight(&json[i]);
+      if (!is_eight_digits(chunk)) {
+        break;
+      }
+      magnitude = magnitude * 100000000 + parse_eight_digits(chunk);
+      i += 8;
+    }
+#endif
+    for (; is_digit(i); ++i) {
+      const auto digit = static_cast<unsigned>(json[i] - '0');
+      if (is_integer && magnitude <= (limit - digit) / 10) {
+        magnitude = magnitude * 10 + digit;
+      } else {
+        is_integer = false;
+      }
+    }
+  }
+
+  if (i < json.size() && json[i] == '.') {
+    ++i;
+    if (!is_digit(i)) {
+      return rapidjson::kParseErrorNumberMissFraction;
+    }
+    i = skip_digits(i);
+    is_integer = false;
+  }
+  if (i < json.size() && (json[i] == 'e' || json[i] == 'E')) {
+    ++i;
+    if (i < json.size() && (json[i] == '+' || json[i] == '-')) {
+      ++i;
+    }
+    if (!is_digit(i)) {
+      return rapidjson::kParseErrorNumberMissExponent;
+    }
+    i = skip_digits(i);
+    is_integer = false;
+  }
+  offset = i;
+
+  bool is_accepted = true;
+  if (is_integer && minus) {
+    if (magnitude <= uint64_t{1} << 31) {
+      is_accepted =
+          visitor(static_cast<int>(-static_cast<int64_t>(magnitude)));
+    } else {
+      is_accepted = visitor(static_cast<int64_t>(~magnitude + 1));
+    }
+  } else if (is_integer) {
+    if (magnitude <= std::numeric_limits<uint32_t>::max()) {
+      is_accepted = visitor(static_cast<unsigned>(magnitude));
+    } else {
+      is_accepted = visitor(magnitude);
+    }
+  } else {
+    double value = 0;
+#if defined(__cpp_lib_to_chars)
+    const auto result =
+        std::from_chars(json.data() + begin, json.data() + i, value);
+    if (result.ec == std::errc::result_out_of_range) {
+      // Overflow to infinity or underflow to zero or denormal
+      value = parse_double(json.substr(begin, i - begin));
+    }
+#else
+    value = parse_double(json.substr(begin, i - begin));
+#endif
+    if (std::isinf(value)) {
+      return rapidjson::kParseErrorNumberTooBig;
+    }
+    is_accepted = visitor(value);
+  }
+
+  return is_accepted ? rapidjson::kParseErrorNone
+                     : rapidjson::kParseErrorTermination;
+}
+
+/**
+ * @brief Parse number to token, @see visit_number
+ *
+ * @param json input
+ * @param offset offset of first byte of number, updated to offset past it
+ * @param token parsed token
+ * @return kParseErrorNone on success, error code otherwise
+ */
+inline rapidjson::ParseErrorCode parse_number(const std::string_view json,
+                                              size_t &offset,
+                                              std::optional<Token> &token) {
+  return visit_number(json, offset, [&token](const auto value) {
+    using V = std::decay_t<decltype(value)>;
+    if constexpr (std::is_same_v<V, int>) {
+      token = Token::create<Token::Type::Int>(value);
+    } else if constexpr (std::is_same_v<V, unsigned>) {
+      token = Token::create<Token::Type::Uint>(value);
+    } else if constexpr (std::is_same_v<V, int64_t>) {
+      token = Token::create<Token::Type::Int64>(value);
+    } else if constexpr (std::is_same_v<V, uint64_t>) {
+      token = Token::create<Token::Type::Uint64>(value);
+    } else {
+      token = Token::create<Token::Type::Double>(value);
+    }
+    return true;
+  });
+}
+
+/**
+ * @brief Parse number or literal: true, false or null
+ *
+ * @param json input
+ * @param offset offset of first byte of scalar, updated to offset past it
+ * @param token parsed token
+ * @return kParseErrorNone on success, error code otherwise
+ */
+inline rapidjson::ParseErrorCode parse_scalar(const std::string_view json,
+                                              size_t &offset,
+                                              std::optional<Token> &token) {
+  const auto rest = json.substr(offset);
+  if (rest.substr(0, 4) == "true") {
+    token = Token::create<Token::Type::Bool>(true);
+    offset += 4;
+  } else if (rest.substr(0, 5) == "false") {
+    token = Token::create<Token::Type::Bool>(false);
+    offset += 5;
+  } else if (rest.substr(0, 4) == "null") {
+    token = Token::create<Token::Type::Null>();
+    offset += 4;
+  } else {
+    return parse_number(json, offset, token);
+  }
+
+  return rapidjson::kParseErrorNone;
+}
+
+} // namespace ctjson::detail
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include <ctjson/detail/OutputBuffer.hpp>
+#include <ctjson/detail/StringScan.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Escape character for each byte, 0 if byte is written as is, 'u' for
+ * \u00XX escape
+ */
+constexpr std::array<char, 256> make_escape_table() {
+  std::array<char, 256> table = {};
+  for (size_t c = 0; c < 0x20; ++c) {
+    table[c] = 'u';
+  }
+  table['\b'] = 'b';
+  table['\f'] = 'f';
+  table['\n'] = 'n';
+  table['\r'] = 'r';
+  table['\t'] = 't';
+  table['"'] = '"';
+  table['\\'] = '\\';
+
+  return table;
+}
+
+inline constexpr auto escape_table = make_escape_table();
+
+/**
+ * @return size of json string for @ref value, including quotes
+ */
+constexpr size_t escaped_size(const std::string_view value) {
+  size_t size = 2;
+  for (const char c : value) {
+    const char escape = escape_table[static_cast<unsigned char>(c)];
+    size += escape == 0 ? 1 : escape == 'u' ? 6 : 2;
+  }
+
+  return size;
+}
+
+/**
+ * @brief Write escaped string without quotes
+ *
+ * Runs of bytes that need no escaping are found with SIMD and copied at
+ * once. Space is reserved for unescaped string, so only bytes to escape go
+ * through capacity check.
+ * @param buffer output buffer
+ * @param out write position with space for @ref value and @ref suffix
+ * @param value string to write
+ * @param suffix number of bytes written by caller after string
+ * @param validate_utf8 replace bytes of invalid UTF-8 sequences with U+FFFD
+ * @return write position with space for @ref suffix
+ */
+inline char *write_escaped(OutputBuffer &buffer, char *out,
+                           const std::string_view value, const size_t suffix,
+                           const bool validate_utf8 = false) {
+  constexpr char hex[] = "0123456789ABCDEF";
+  constexpr std::string_view replacement = "\xEF\xBF\xBD";
+
+  size_t i = 0;
+  while (true) {
+    const auto clean =
+        find_special(value.data() + i, value.size() - i, validate_utf8);
+    std::memcpy(out, value.data() + i, clean);
+    out += clean;
+    i += clean;
+    if (i == value.size()) {
+      break;
+    }
+
+    const auto c = static_cast<unsigned char>(value[i]);
+    const char escape = escape_table[c];
+    if (escape == 0) {
+      // Non-ASCII byte while validating
+      const auto size = utf8_sequence_size(value.data() + i, value.size() - i);
+      if (size > 0) {
+        std::memcpy(out, value.data() + i, size);
+        out += size;
+        i += size;
+        continue;
+      }
+
+      buffer.commit(out);
+      out = buffer.reserve(replacement.size() + (value.size() - i - 1) +
+                           suffix);
+      std::memcpy(out, replacement.data(), replacement.size());
+      out += replacement.size();
+      ++i;
+      continue;
+    }
+
+    // Escape, rest of value and suffix, so exact size is never exceeded
+    buffer.commit(out);
+    const size_t escape_size = escape == 'u' ? 6 : 2;
+    out = buffer.reserve(escape_size + (value.size() - i - 1) + suffix);
+    *out++ = '\\';
+    *out++ = escape;
+    if (escape == 'u') {
+      *out++ = '0';
+      *out++ = '0';
+      *out++ = hex[c >> 4];
+      *out++ = hex[c & 0xF];
+    }
+    ++i;
+  }
+
+  return out;
+}
+
+/**
+ * @brief Write json string: quoted and escaped
+ *
+ * @param buffer output buffer
+ * @param value string to write
+ * @param validate_utf8 replace bytes of invalid UTF-8 sequences with U+FFFD
+ */
+inline void write_string(OutputBuffer &buffer, const std::string_view value,
+                         const bool validate_utf8 = false) {
+  // Value and quotes
+  char *out = buffer.reserve(value.size() + 2);
+  *out++ = '"';
+  out = write_escaped(buffer, out, value, 1, validate_utf8);
+  *out++ = '"';
+  buffer.commit(out);
+}
+
+} // namespace ctjson::detail
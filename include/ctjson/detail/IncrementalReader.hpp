@@ -0,0 +1,388 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rapidjson/error/error.h>
+
+#include <ctjson/detail/Decode.hpp>
+#include <ctjson/detail/StringScan.hpp>
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Result of reading available part of input
+ */
+enum class ReadStatus {
+  NeedMoreInput, // All complete tokens are read, the rest is incomplete
+  Done,          // Root value is complete
+  Error,         // Input is invalid or handler failed
+};
+
+/**
+ * @brief Resumable json reader, fed with input in parts
+ *
+ * Only complete tokens are read and passed to rapidjson-like handler, the
+ * number of consumed bytes is returned, so the caller keeps the incomplete
+ * rest and passes it again with more input. State of grammar persists
+ * between calls, so each byte is read about once, except for incomplete
+ * numbers and literals. Grammar and errors are the same as of rapidjson
+ * reader with trailing commas allowed and content after the root value
+ * ignored.
+ */
+class IncrementalReader {
+public:
+  /**
+   * @brief Read complete tokens of @ref data
+   *
+   * @param data input, starting with the rest not consumed by previous call
+   * @param last there is no more input after @ref data
+   * @param handler receiver of parser events, @see rapidjson::Handler
+   * @param consumed number of bytes of @ref data read
+   * @return status of reading
+   */
+  template <typename Handler>
+  ReadStatus read(const std::string_view data, const bool last,
+                  Handler &handler, size_t &consumed) {
+    consumed = 0;
+    if (m_error != rapidjson::kParseErrorNone) {
+      return ReadStatus::Error;
+    }
+
+    size_t i = 0;
+    for (;;) {
+      while (i < data.size() && is_whitespace(data[i])) {
+        ++i;
+      }
+      consumed = i;
+      if (m_state == State::Done) {
+        return ReadStatus::Done;
+      }
+      if (i == data.size()) {
+        return last ? fail(end_error()) : ReadStatus::NeedMoreInput;
+      }
+
+      const char c = data[i];
+      switch (m_state) {
+      case State::Root:
+      case State::Value:
+        break;
+      case State::Key:
+        if (c == '}') {
+          if (!end_container(handler)) {
+            return fail(rapidjson::kParseErrorTermination);
+          }
+          ++i;
+          continue;
+        }
+        if (c != '"') {
+          return fail(rapidjson::kParseErrorObjectMissName);
+        }
+        ++m_stack.back().size;
+        break;
+      case State::Colon:
+        if (c != ':') {
+          return fail(rapidjson::kParseErrorObjectMissColon);
+        }
+        ++i;
+        m_state = State::Value;
+        continue;
+      case State::ObjectNext:
+        if (m_trailing_garbage || (c != ',' && c != '}')) {
+          return fail(rapidjson::kParseErrorObjectMissCommaOrCurlyBracket);
+        }
+        ++i;
+        if (c == ',') {
+          m_state = State::Key;
+        } else if (!end_container(handler)) {
+          return fail(rapidjson::kParseErrorTermination);
+        }
+        continue;
+      case State::Element:
+        if (c == ']') {
+          if (!end_container(handler)) {
+            return fail(rapidjson::kParseErrorTermination);
+          }
+          ++i;
+          continue;
+        }
+        ++m_stack.back().size;
+        break;
+      case State::ArrayNext:
+        if (m_trailing_garbage || (c != ',' && c != ']')) {
+          return fail(rapidjson::kParseErrorArrayMissCommaOrSquareBracket);
+        }
+        ++i;
+        if (c == ',') {
+          m_state = State::Element;
+        } else if (!end_container(handler)) {
+          return fail(rapidjson::kParseErrorTermination);
+        }
+        continue;
+      case State::Done:
+        break;
+      }
+
+      // Value, or key in Key state
+      size_t end = i;
+      const auto code = read_value(data, last, handler, end);
+      if (code != rapidjson::kParseErrorNone) {
+        return fail(code);
+      }
+      if (end == i) {
+        // Value is not complete, it is counted again with more input
+        if (m_state == State::Key || m_state == State::Element) {
+          --m_stack.back().size;
+        }
+        return ReadStatus::NeedMoreInput;
+      }
+      i = end;
+    }
+  }
+
+  /**
+   * @return error
+   * @pre last read returned ReadStatus::Error
+   */
+  rapidjson::ParseErrorCode get_error() const { return m_error; }
+
+private:
+  /**
+   * @brief Expected input, @see IndexedTokenStream
+   */
+  enum class State : uint8_t {
+    Root,
+    Key,
+    Colon,
+    Value,
+    ObjectNext,
+    Element,
+    ArrayNext,
+    Done
+  };
+
+  /**
+   * @brief Object or array being parsed
+   */
+  struct Container {
+    bool is_array;
+    unsigned size;
+  };
+
+  static constexpr bool is_whitespace(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  /**
+   * @brief Read value or key starting at @ref end, which is set past it
+   *
+   * @ref end is unchanged if value is not complete
+   */
+  template <typename Handler>
+  rapidjson::ParseErrorCode read_value(const std::string_view data,
+                                       const bool last, Handler &handler,
+                                       size_t &end) {
+    const size_t begin = end;
+    const char c = data[begin];
+    if (m_state == State::Key || c == '"') {
+      const size_t quote = find_string_end(data, begin);
+      if (quote == data.size() && !last) {
+        return rapidjson::kParseErrorNone;
+      }
+      m_scanned = 0;
+
+      m_string.clear();
+      const auto code = decode_string(data, begin, m_string);
+      if (code != rapidjson::kParseErrorNone) {
+        return code;
+      }
+      const auto size = static_cast<unsigned>(m_string.size());
+      const bool is_key = m_state == State::Key;
+      if (!(is_key ? handler.Key(m_string.data(), size, true)
+                   : handler.String(m_string.data(), size, true))) {
+        return rapidjson::kParseErrorTermination;
+      }
+      end = quote + 1;
+      if (is_key) {
+        m_state = State::Colon;
+      } else {
+        after_value();
+      }
+
+      return rapidjson::kParseErrorNone;
+    }
+
+    switch (c) {
+    case '{':
+      m_stack.push_back({false, 0});
+      m_state = State::Key;
+      end = begin + 1;
+      return handler.StartObject() ? rapidjson::kParseErrorNone
+                                   : rapidjson::kParseErrorTermination;
+    case '[':
+      m_stack.push_back({true, 0});
+      m_state = State::Element;
+      end = begin + 1;
+      return handler.StartArray() ? rapidjson::kParseErrorNone
+                                  : rapidjson::kParseErrorTermination;
+    case '}':
+    case ']':
+    case ':':
+    case ',':
+      return rapidjson::kParseErrorValueInvalid;
+    default:
+      break;
+    }
+
+    // Scalar spans up to the next delimiter, which should be available
+    size_t scalar_end = begin;
+    while (scalar_end < data.size() && !is_scalar_end(data[scalar_end])) {
+      ++scalar_end;
+    }
+    if (scalar_end == data.size() && !last) {
+      return rapidjson::kParseErrorNone;
+    }
+
+    size_t parsed = begin;
+    std::optional<Token> token;
+    const auto code = parse_scalar(data.substr(0, scalar_end), parsed, token);
+    if (code != rapidjson::kParseErrorNone) {
+      return code;
+    }
+    if (!emit_scalar(handler, token.value())) {
+      return rapidjson::kParseErrorTermination;
+    }
+    end = scalar_end;
+    after_value();
+    // Rest of scalar is reported by the next token, as by rapidjson
+    m_trailing_garbage = parsed != scalar_end;
+
+    return rapidjson::kParseErrorNone;
+  }
+
+  /**
+   * @brief Find closing quote of string, resuming scan of incomplete string
+   * from previous call
+   *
+   * @param data input
+   * @param begin offset of opening quote
+   * @return offset of closing quote, data.size() if string is incomplete
+   */
+  size_t find_string_end(const std::string_view data, const size_t begin) {
+    size_t i = begin + 1 + m_scanned;
+    while (i < data.size()) {
+      i += find_special(data.data() + i, data.size() - i, false);
+      if (i == data.size()) {
+        break;
+      }
+      if (data[i] == '"') {
+        return i;
+      }
+      if (data[i] == '\\') {
+        if (i + 1 == data.size()) {
+          // Escape is rescanned with more input
+          break;
+        }
+        ++i;
+      }
+      ++i;
+    }
+
+    m_scanned = i - begin - 1;
+    return data.size();
+  }
+
+  /**
+   * @brief Pass scalar token to handler
+   */
+  template <typename Handler>
+  static bool emit_scalar(Handler &handler, const Token &token) {
+    using Type = Token::Type;
+    if (token.is_of_type<Type::Null>()) {
+      return handler.Null();
+    } else if (token.is_of_type<Type::Bool>()) {
+      return handler.Bool(token.value<Type::Bool>());
+    } else if (token.is_of_type<Type::Int>()) {
+      return handler.Int(token.value<Type::Int>());
+    } else if (token.is_of_type<Type::Uint>()) {
+      return handler.Uint(token.value<Type::Uint>());
+    } else if (token.is_of_type<Type::Int64>()) {
+      return handler.Int64(token.value<Type::Int64>());
+    } else if (token.is_of_type<Type::Uint64>()) {
+      return handler.Uint64(token.value<Type::Uint64>());
+    } else {
+      return handler.Double(token.value<Type::Double>());
+    }
+  }
+
+  /**
+   * @brief Close current container
+   */
+  template <typename Handler>
+  bool end_container(Handler &handler) {
+    const auto container = m_stack.back();
+    m_stack.pop_back();
+    after_value();
+
+    return container.is_array ? handler.EndArray(container.size)
+                              : handler.EndObject(container.size);
+  }
+
+  /**
+   * @brief Update state after complete value
+   */
+  void after_value() {
+    m_trailing_garbage = false;
+    if (m_stack.empty()) {
+      m_state = State::Done;
+    } else if (m_stack.back().is_array) {
+      m_state = State::ArrayNext;
+    } else {
+      m_state = State::ObjectNext;
+    }
+  }
+
+  /**
+   * @return error of unexpected end of input in current state
+   */
+  rapidjson::ParseErrorCode end_error() const {
+    switch (m_state) {
+    case State::Root:
+      return rapidjson::kParseErrorDocumentEmpty;
+    case State::Key:
+      return rapidjson::kParseErrorObjectMissName;
+    case State::Colon:
+      return rapidjson::kParseErrorObjectMissColon;
+    case State::ObjectNext:
+      return rapidjson::kParseErrorObjectMissCommaOrCurlyBracket;
+    case State::ArrayNext:
+      return rapidjson::kParseErrorArrayMissCommaOrSquareBracket;
+    default:
+      return rapidjson::kParseErrorValueInvalid;
+    }
+  }
+
+  ReadStatus fail(const rapidjson::ParseErrorCode code) {
+    m_error = code;
+    return ReadStatus::Error;
+  }
+
+private:
+  State m_state = State::Root;
+  std::vector<Container> m_stack;
+  // Last scalar is followed by bytes that can not follow value
+  bool m_trailing_garbage = false;
+  // Number of bytes of incomplete string known not to contain its end
+  size_t m_scanned = 0;
+  // Buffer for decoded strings, reused
+  std::string m_string;
+
+  rapidjson::ParseErrorCode m_error = rapidjson::kParseErrorNone;
+};
+
+} // namespace ctjson::detail
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <ctjson/detail/Escape.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Fragments of N keys stored contiguously
+ *
+ * @tparam N number of keys
+ * @tparam Size total size of fragments
+ */
+template <size_t N, size_t Size>
+struct FragmentStorage {
+  std::array<char, Size> chars = {};
+  // Fragment i is [offsets[i], offsets[i + 1])
+  std::array<size_t, N + 1> offsets = {};
+};
+
+/**
+ * @return total size of fragments for @ref keys, @see KeyFragments
+ */
+template <size_t N>
+constexpr size_t
+fragments_size(const std::array<std::string_view, N> &keys) {
+  size_t result = N > 0 ? N - 1 : 0; // Commas
+  for (const auto key : keys) {
+    result += escaped_size(key) + 1; // Colon
+  }
+
+  return result;
+}
+
+/**
+ * @brief Render fragments for @ref keys, @see KeyFragments
+ */
+template <size_t N, size_t Size>
+constexpr FragmentStorage<N, Size>
+build_fragments(const std::array<std::string_view, N> &keys) {
+  constexpr char hex[] = "0123456789ABCDEF";
+
+  FragmentStorage<N, Size> result;
+  size_t out = 0;
+  for (size_t i = 0; i < N; ++i) {
+    result.offsets[i] = out;
+    if (i > 0) {
+      result.chars[out++] = ',';
+    }
+    result.chars[out++] = '"';
+    for (const char c : keys[i]) {
+      const auto byte = static_cast<unsigned char>(c);
+      const char escape = escape_table[byte];
+      if (escape == 0) {
+        result.chars[out++] = c;
+        continue;
+      }
+
+      result.chars[out++] = '\\';
+      result.chars[out++] = escape;
+      if (escape == 'u') {
+        result.chars[out++] = '0';
+        result.chars[out++] = '0';
+        result.chars[out++] = hex[byte >> 4];
+        result.chars[out++] = hex[byte & 0xF];
+      }
+    }
+    result.chars[out++] = '"';
+    result.chars[out++] = ':';
+  }
+  result.offsets[N] = out;
+
+  return result;
+}
+
+/**
+ * @brief Compile-time json fragments preceding object members: separator,
+ * quoted and escaped key and colon, e.g. `"a":` and `,"b":`
+ *
+ * So each key is written with one copy, without escaping.
+ * @tparam keys reference to constexpr std::array of keys,
+ * @see ctjson::field_names
+ */
+template <const auto &keys>
+class KeyFragments {
+  using Keys = std::decay_t<decltype(keys)>;
+
+public:
+  // Number of keys
+  constexpr static size_t size = std::tuple_size_v<Keys>;
+
+private:
+  static_assert(std::is_same_v<Keys, std::array<std::string_view, size>>,
+                "Keys should be std::array of std::string_view");
+
+  constexpr static auto storage =
+      build_fragments<size, fragments_size(keys)>(keys);
+
+public:
+  /**
+   * @tparam index index of key
+   * @return fragment preceding value of key @ref index, with comma unless
+   * the key is first
+   */
+  template <size_t index>
+  constexpr static std::string_view get() {
+    static_assert(index < size, "Key index out of range");
+    return {storage.chars.data() + storage.offsets[index],
+            storage.offsets[index + 1] - storage.offsets[index]};
+  }
+};
+
+} // namespace ctjson::detail
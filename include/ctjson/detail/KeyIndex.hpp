@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Seeded FNV-1a hash with final mixing, usable at compile time
+ *
+ * @param key key to hash
+ * @param seed seed selecting hash function from family
+ * @return hash of @ref key
+ */
+constexpr uint32_t key_hash(const std::string_view key,
+                            const uint32_t seed) noexcept {
+  uint32_t hash = 2166136261u ^ seed;
+  for (const char c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+
+  hash ^= hash >> 16;
+  hash *= 0x7feb352du;
+  hash ^= hash >> 15;
+
+  return hash;
+}
+
+/**
+ * @return smallest power of two not less than @ref n
+ */
+constexpr size_t next_pow2(const size_t n) noexcept {
+  size_t result = 1;
+  while (result < n) {
+    result *= 2;
+  }
+
+  return result;
+}
+
+/**
+ * @brief Perfect hash table mapping N keys to their indices
+ *
+ * @tparam N number of keys
+ * @tparam Capacity maximum number of slots
+ */
+template <size_t N, size_t Capacity>
+struct PerfectHash {
+  uint32_t seed = 0;
+  size_t mask = 0;
+  std::array<size_t, Capacity> slots = {}; // Key index or N for empty slot
+};
+
+/**
+ * @return true if there are equal keys in @ref keys
+ */
+template <size_t N>
+constexpr bool has_duplicates(const std::array<std::string_view, N> &keys) {
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = i + 1; j < N; ++j) {
+      if (keys[i] == keys[j]) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Search for seed and table size giving no collisions
+ *
+ * @param keys distinct keys
+ * @return perfect hash table for @ref keys
+ */
+template <size_t N, size_t Capacity>
+constexpr PerfectHash<N, Capacity>
+build_perfect_hash(const std::array<std::string_view, N> &keys) {
+  constexpr uint32_t max_seed = 4096;
+
+  for (size_t size = next_pow2(N); size <= Capacity; size *= 2) {
+    for (uint32_t seed = 0; seed < max_seed; ++seed) {
+      PerfectHash<N, Capacity> result;
+      result.seed = seed;
+      result.mask = size - 1;
+      for (size_t i = 0; i < Capacity; ++i) {
+        result.slots[i] = N;
+      }
+
+      bool collision = false;
+      for (size_t i = 0; i < N && !collision; ++i) {
+        const auto slot = key_hash(keys[i], seed) & result.mask;
+        collision = result.slots[slot] != N;
+        result.slots[slot] = i;
+      }
+
+      if (!collision) {
+        return result;
+      }
+    }
+  }
+
+  // Not a constant expression, so compilation fails if reached
+  throw "No perfect hash found for keys";
+}
+
+/**
+ * @brief Compile-time index of keys
+ *
+ * Lookup takes one hash of the key, one table load and one comparison
+ * (length, then memcmp), without any allocation.
+ *
+ * @tparam keys reference to constexpr std::array of distinct keys,
+ * @see ctjson::field_names
+ */
+template <const auto &keys>
+class KeyIndex {
+  using Keys = std::decay_t<decltype(keys)>;
+
+public:
+  // Number of keys
+  constexpr static size_t size = std::tuple_size_v<Keys>;
+
+private:
+  static_assert(std::is_same_v<Keys, std::array<std::string_view, size>>,
+                "Keys should be std::array of std::string_view");
+  static_assert(!has_duplicates(keys), "Keys should be distinct");
+
+  constexpr static size_t capacity = next_pow2(size) * 4;
+  constexpr static auto table = build_perfect_hash<size, capacity>(keys);
+
+public:
+  /**
+   * @param key key to find
+   * @return 0-based index of @ref key in keys or @ref size if not found
+   */
+  static constexpr size_t find(const std::string_view key) noexcept {
+    const auto index = table.slots[key_hash(key, table.seed) & table.mask];
+    if (index < size && keys[index] == key) {
+      return index;
+    }
+
+    return size;
+  }
+};
+
+} // namespace ctjson::detail
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ctjson::detail {
+/**
+ * @brief This class maintain the path in json, recording only positions
+ *
+ * Unlike @ref Path, keys are not copied: only offset in input is recorded
+ * for each key, and keys are read back from input when path is rendered.
+ */
+class LazyPath {
+  /**
+   * @brief Path component for object or array
+   */
+  struct Component {
+    // Component is array
+    bool is_array = false;
+    // Index in array, -1 before first element
+    std::ptrdiff_t index = -1;
+    // Offset in input to search current key from, npos before first key
+    size_t key = std::string::npos;
+  };
+
+public:
+  /**
+   * Called on StartObject token
+   */
+  void start_object() {
+    advance_array_if_needed();
+    m_path.push_back(Component{});
+  }
+
+  /**
+   * Called on Key token
+   *
+   * @param offset offset in input, at which search for key starts
+   */
+  void key(size_t offset) { m_path.back().key = offset; }
+
+  /**
+   * Called on EndObject token
+   */
+  void end_object() {
+    // TODO: Check that last item is Object
+    m_path.pop_back();
+  }
+
+  /**
+   * Called on StartArray token
+   */
+  void start_array() {
+    advance_array_if_needed();
+    m_path.push_back(Component{.is_array = true});
+  }
+
+  /**
+   * Called on any Value token
+   */
+  void value() { advance_array_if_needed(); }
+
+  /**
+   * Called on EndArray token
+   */
+  void end_array() {
+    // TODO: Check that last item is Array
+    m_path.pop_back();
+  }
+
+  /**
+   * @tparam KeyReader type of key reader
+   * @param read_key called with recorded key offset, returns key
+   * @return Rendered path begining with "root"
+   */
+  template <typename KeyReader>
+  std::string render(KeyReader read_key) const {
+    std::string result = "root";
+    for (const auto &component : m_path) {
+      if (component.is_array) {
+        if (component.index != -1) {
+          result += "[" + std::to_string(component.index) + "]";
+        }
+      } else if (component.key != std::string::npos) {
+        result += "." + read_key(component.key);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  /**
+   * Called on new object, array or value
+   */
+  void advance_array_if_needed() {
+    if (m_path.empty() || !m_path.back().is_array) {
+      return;
+    }
+
+    ++m_path.back().index;
+  }
+
+private:
+  std::vector<Component> m_path;
+};
+} // namespace ctjson::detail
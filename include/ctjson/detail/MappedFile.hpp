@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Read-only memory mapping of whole file
+ *
+ * Pages are mapped with sequential access hint, so they are read ahead and
+ * could be reclaimed early while parsing
+ */
+class MappedFile {
+public:
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept
+      : m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)) {}
+
+  ~MappedFile() {
+    if (m_data != nullptr) {
+      munmap(m_data, m_size);
+    }
+  }
+
+  /**
+   * @brief Map file to memory
+   *
+   * @param path path to file
+   * @param error set to error message on failure
+   * @return mapped file or std::nullopt on failure
+   */
+  static std::optional<MappedFile> open(const std::string &path,
+                                        std::string &error) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      error = errno_error("Can not open file " + path);
+      return std::nullopt;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+      error = errno_error("Can not stat file " + path);
+      close(fd);
+      return std::nullopt;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+      // Empty mapping is not allowed, empty file is empty input
+      close(fd);
+      return MappedFile(nullptr, 0);
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // Mapping keeps file referenced
+    if (data == MAP_FAILED) {
+      error = errno_error("Can not map file " + path);
+      return std::nullopt;
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return MappedFile(data, size);
+  }
+
+  /**
+   * @return pointer to file content
+   */
+  const char *data() const { return static_cast<const char *>(m_data); }
+
+  /**
+   * @return file size
+   */
+  size_t size() const { return m_size; }
+
+private:
+  MappedFile(void *data, size_t size) : m_data(data), m_size(size) {}
+
+  static std::string errno_error(std::string message) {
+    return message + ": " + std::strerror(errno);
+  }
+
+private:
+  void *m_data;
+  size_t m_size;
+};
+
+} // namespace ctjson::detail
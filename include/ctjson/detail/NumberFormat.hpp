@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if !defined(__cpp_lib_to_chars)
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+namespace ctjson::detail {
+
+/**
+ * @brief Formatting of floating point values
+ *
+ * Shortest is the shortest representation that reads back to the same value,
+ * fixed is fixed notation with @ref precision digits after decimal point
+ */
+struct FloatFormat {
+  // Precision value for shortest representation
+  constexpr static int shortest = -1;
+  // Maximal precision of fixed notation
+  constexpr static int max_precision = 32;
+
+  int precision = shortest;
+
+  /**
+   * @return true if format is shortest representation
+   */
+  constexpr bool is_shortest() const { return precision < 0; }
+};
+
+/**
+ * @return maximal size of formatted integer of type @tparam Int
+ */
+template <typename Int>
+constexpr size_t max_integer_size() {
+  // Sign and digits
+  return std::numeric_limits<Int>::digits10 + 2;
+}
+
+/**
+ * @return maximal size of formatted floating point value of type
+ * @tparam Floating in @ref format, including ".0" suffix
+ */
+template <typename Floating>
+constexpr size_t max_floating_size(const FloatFormat format) {
+  if (format.is_shortest()) {
+    // Sign, digits, point, exponent and ".0" suffix
+    return std::numeric_limits<Floating>::max_digits10 + 12;
+  }
+
+  // Sign, integer part, point and fractional part
+  return std::numeric_limits<Floating>::max_exponent10 + 4 + format.precision;
+}
+
+/**
+ * @return maximal size of formatted floating point value of type
+ * @tparam Floating in any format
+ */
+template <typename Floating>
+constexpr size_t max_floating_size() {
+  return std::max(max_floating_size<Floating>({}),
+                  max_floating_size<Floating>({FloatFormat::max_precision}));
+}
+
+/**
+ * @brief Pairs of decimal digits: "00", "01", ..., "99"
+ */
+inline constexpr char digit_pairs[] = "00010203040506070809"
+                                      "10111213141516171819"
+                                      "20212223242526272829"
+                                      "30313233343536373839"
+                                      "40414243444546474849"
+                                      "50515253545556575859"
+                                      "60616263646566676869"
+                                      "70717273747576777879"
+                                      "80818283848586878889"
+                                      "90919293949596979899";
+
+/**
+ * @return number of decimal digits in @ref value
+ */
+template <typename UInt>
+inline unsigned count_digits(UInt value) {
+  unsigned result = 1;
+  for (;;) {
+    if (value < 10) {
+      return result;
+    }
+    if (value < 100) {
+      return result + 1;
+    }
+    if (value < 1000) {
+      return result + 2;
+    }
+    if (value < 10000) {
+      return result + 3;
+    }
+    value /= 10000;
+    result += 4;
+  }
+}
+
+/**
+ * @brief Write decimal digits of @ref value, two digits per step, from the
+ * end
+ *
+ * @return pointer past last written char
+ */
+template <typename UInt>
+inline char *write_digits(char *out, UInt value) {
+  char *end = out + count_digits(value);
+  char *p = end;
+  while (value >= 100) {
+    const auto pair = static_cast<unsigned>(value % 100) * 2;
+    value /= 100;
+    p -= 2;
+    std::memcpy(p, digit_pairs + pair, 2);
+  }
+  if (value >= 10) {
+    std::memcpy(p - 2, digit_pairs + static_cast<unsigned>(value) * 2, 2);
+  } else {
+    *(p - 1) = static_cast<char>('0' + value);
+  }
+
+  return end;
+}
+
+/**
+ * @brief Write integer in decimal form
+ *
+ * @param out output, at least @ref max_integer_size bytes
+ * @return pointer past last written char
+ */
+template <typename Int>
+inline char *write_integer(char *out, const Int value) {
+  using UInt = std::make_unsigned_t<Int>;
+
+  UInt magnitude = static_cast<UInt>(value);
+  if constexpr (std::is_signed_v<Int>) {
+    if (value < 0) {
+      *out++ = '-';
+      magnitude = static_cast<UInt>(0) - magnitude;
+    }
+  }
+
+  // 32-bit division is cheaper
+  if constexpr (sizeof(UInt) > sizeof(uint32_t)) {
+    if (magnitude <= std::numeric_limits<uint32_t>::max()) {
+      return write_digits(out, static_cast<uint32_t>(magnitude));
+    }
+  }
+
+  return write_digits(out, magnitude);
+}
+
+/**
+ * @brief Write finite floating point value
+ *
+ * Floating point std::to_chars is used where standard library provides it,
+ * otherwise value is written by snprintf.
+ *
+ * Written value always has decimal point or exponent, to be distinguishable
+ * from integers
+ * @param out output, at least @ref max_floating_size bytes
+ * @return pointer past last written char
+ * @pre value is finite
+ */
+template <typename Floating>
+inline char *write_floating(char *out, const Floating value,
+                            const FloatFormat format) {
+  const auto end = out + max_floating_size<Floating>(format);
+  const auto begin = out;
+#if defined(__cpp_lib_to_chars)
+  if (format.is_shortest()) {
+    out = std::to_chars(out, end, value).ptr;
+  } else {
+    out = std::to_chars(out, end, value, std::chars_format::fixed,
+                        format.precision)
+              .ptr;
+  }
+#else
+  if (format.is_shortest()) {
+    /**
+     * Value with shortest form of at most digits10 digits is written exactly
+     * with digits10 digits, otherwise digits are added until value reads
+     * back, strtod uses the same locale as snprintf
+     */
+    for (int precision = std::numeric_limits<Floating>::digits10;;
+         ++precision) {
+      out = begin + std::snprintf(begin, end - begin, "%.*g", precision,
+                                  static_cast<double>(value));
+      if (precision >= std::numeric_limits<Floating>::max_digits10 ||
+          static_cast<Floating>(std::strtod(begin, nullptr)) == value) {
+        break;
+      }
+    }
+  } else {
+    out += std::snprintf(out, end - out, "%.*f", format.precision,
+                         static_cast<double>(value));
+  }
+
+  // Decimal point of current locale is replaced
+  for (char *p = begin; p != out; ++p) {
+    if (*p == ',') {
+      *p = '.';
+    }
+  }
+#endif
+
+  if (std::memchr(begin, '.', out - begin) == nullptr &&
+      std::memchr(begin, 'e', out - begin) == nullptr) {
+    *out++ = '.';
+    *out++ = '0';
+  }
+
+  return out;
+}
+
+} // namespace ctjson::detail
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Growable contiguous output buffer
+ *
+ * Writers reserve space for the longest possible output of a value once and
+ * then write through raw pointer, committing the actual end afterwards:
+ * @code{.cpp}
+ * char *out = buffer.reserve(max_size);
+ * ... // *out++ = c;
+ * buffer.commit(out);
+ * @endcode
+ * Storage is a std::string, so result is released without copying.
+ * Alternatively buffer writes to fixed external storage, then output past its
+ * capacity is discarded and buffer is marked as overflowed, @see overflowed.
+ */
+class OutputBuffer {
+public:
+  /**
+   * @param capacity initial capacity
+   */
+  explicit OutputBuffer(const size_t capacity = 256) {
+    // Resize alone may allocate more
+    m_storage.reserve(capacity);
+    m_storage.resize(capacity);
+    m_data = m_storage.data();
+    m_capacity = capacity;
+  }
+
+  /**
+   * @param data external storage, should outlive the buffer
+   * @param capacity size of @ref data
+   */
+  OutputBuffer(char *data, const size_t capacity)
+      : m_data(data), m_capacity(capacity), m_external(true) {}
+
+  OutputBuffer(OutputBuffer &&other) noexcept { take(other); }
+  OutputBuffer(const OutputBuffer &other) = delete;
+
+  OutputBuffer &operator=(OutputBuffer &&other) noexcept {
+    if (this != &other) {
+      take(other);
+    }
+
+    return *this;
+  }
+
+  /**
+   * @brief Make sure that @ref size bytes can be written
+   *
+   * @return write position, valid until next reserve
+   */
+  char *reserve(const size_t size) {
+    if (available() < size) {
+      grow(size);
+    }
+
+    return m_data + m_size;
+  }
+
+  /**
+   * @return number of bytes that can be written without growing
+   */
+  size_t available() const { return m_capacity - m_size; }
+
+  /**
+   * @brief Set end of written data
+   *
+   * @param end write position after last written byte
+   * @pre @ref end is within space returned by last reserve
+   */
+  void commit(const char *end) { m_size = end - m_data; }
+
+  /**
+   * @brief Append one byte
+   */
+  void put(const char c) {
+    *reserve(1) = c;
+    ++m_size;
+  }
+
+  /**
+   * @brief Append bytes
+   */
+  void append(const std::string_view data) {
+    std::memcpy(reserve(data.size()), data.data(), data.size());
+    m_size += data.size();
+  }
+
+  /**
+   * @return true if output did not fit external storage, written data is
+   * incomplete then
+   */
+  bool overflowed() const { return m_overflow; }
+
+  /**
+   * @return written data
+   */
+  std::string_view view() const { return {m_data, m_size}; }
+
+  /**
+   * @return number of written bytes
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * @brief Discard written data, keeping capacity
+   */
+  void clear() { m_size = 0; }
+
+  /**
+   * @return written data, buffer is left empty
+   */
+  std::string release() {
+    std::string result;
+    if (m_external) {
+      result.assign(m_data, m_size);
+    } else {
+      m_storage.resize(m_size);
+      result = std::move(m_storage);
+      m_data = nullptr;
+      m_capacity = 0;
+    }
+    m_size = 0;
+
+    return result;
+  }
+
+private:
+  /**
+   * @brief Grow capacity geometrically to fit @ref size more bytes
+   *
+   * External storage is not grown: buffer is marked as overflowed and the
+   * rest of output is written over scratch space in own storage
+   */
+  void grow(const size_t size) {
+    if (m_external) {
+      m_overflow = true;
+      m_size = 0;
+      if (m_storage.size() < size) {
+        m_storage.resize(size);
+      }
+      m_data = m_storage.data();
+      m_capacity = m_storage.size();
+      return;
+    }
+
+    m_storage.resize(std::max(m_capacity * 2, m_size + size));
+    m_data = m_storage.data();
+    m_capacity = m_storage.size();
+  }
+
+  /**
+   * @brief Move state of @ref other, which is left empty
+   */
+  void take(OutputBuffer &other) {
+    // Data may be stored inline in std::string, so it is re-read after move
+    const bool is_own = !other.m_external || other.m_overflow;
+    m_storage = std::move(other.m_storage);
+    m_data = is_own ? m_storage.data() : other.m_data;
+    m_capacity = other.m_capacity;
+    m_size = other.m_size;
+    m_external = other.m_external;
+    m_overflow = other.m_overflow;
+
+    other.m_storage = std::string();
+    other.m_data = nullptr;
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_external = false;
+    other.m_overflow = false;
+  }
+
+  std::string m_storage;
+  char *m_data = nullptr;
+  size_t m_capacity = 0;
+  size_t m_size = 0;
+  bool m_external = false;
+  // Output did not fit external storage
+  bool m_overflow = false;
+};
+
+} // namespace ctjson::detail
@@ -2,6 +2,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -50,9 +51,13 @@ public:
   /**
    * Called on Key token
    */
-  void key(std::string key) {
+  void key(std::string_view key) {
     auto &object = std::get<Object>(m_path.back());
-    object.key = std::move(key);
+    if (object.key) {
+      object.key->assign(key); // Reuse capacity of previous key
+    } else {
+      object.key.emplace(key);
+    }
   }
 
   /**
@@ -87,8 +92,14 @@ public:
   /**
    * @return Rendered path begining with "root"
    */
-  std::string render() const {
-    std::string result = "root";
+  std::string render() const { return render("root"); }
+
+  /**
+   * @param prefix rendered path of json containing this one
+   * @return Rendered path begining with @ref prefix
+   */
+  std::string render(std::string prefix) const {
+    std::string result = std::move(prefix);
     for (const auto &component : m_path) {
       result += std::visit([](const auto &c) { return c.render(); }, component);
     }
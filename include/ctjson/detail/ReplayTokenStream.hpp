@@ -0,0 +1,188 @@
+#pragma once
+
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <ctjson/detail/Path.hpp>
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Token stream replaying buffered tokens of one json value
+ *
+ * Used to run pull deserialization on subtree collected by push parser.
+ * Path is maintained relative to the path of replayed value.
+ */
+class ReplayTokenStream {
+public:
+  using token_type = Token;
+
+  // Buffer of tokens, reused between values
+  using Buffer = std::vector<std::optional<Token>>;
+
+public:
+  /**
+   * @param tokens buffered tokens of complete json value
+   * @param prefix renders path of replayed value, called only on error
+   * @param resource memory resource for parsed values
+   */
+  ReplayTokenStream(Buffer &tokens, std::function<std::string()> prefix,
+                    std::pmr::memory_resource *resource)
+      : m_tokens(tokens), m_prefix(std::move(prefix)), m_resource(resource) {}
+
+  /**
+   * @return false, buffered tokens are always valid
+   */
+  bool has_error() const { return false; }
+
+  /**
+   * @pre has_error() == true
+   */
+  std::string_view get_error() const { return {}; }
+
+  /**
+   * @return memory resource for parsed values
+   */
+  std::pmr::memory_resource *memory_resource() const { return m_resource; }
+
+  /**
+   * @return true if all tokens are replayed
+   */
+  bool is_complete() const { return m_index == m_tokens.size(); }
+
+  /**
+   * @brief Peek next token
+   * @return   std::nullopt if there is no next token,
+   *           reference to next token otherwise
+   */
+  const std::optional<Token> &peek() {
+    if (is_complete()) {
+      return m_end;
+    }
+
+    on_advance();
+
+    return m_tokens[m_index];
+  }
+
+  /**
+   * @brief Retrieve next token
+   * @return   std::nullopt if there is no next token,
+   *           next token otherwise
+   */
+  std::optional<Token> next() {
+    if (is_complete()) {
+      return std::nullopt;
+    }
+
+    on_advance();
+
+    return std::move(m_tokens[m_index++]);
+  }
+
+  /**
+   * @brief Skip next value
+   *
+   * Tokens of value are skipped in buffer, path is updated only for value
+   * itself
+   * @return true if value was skipped, false on end of tokens or if there is
+   * no value before end of container
+   */
+  bool skip_value() {
+    if (is_complete()) {
+      return false;
+    }
+
+    const auto &first = m_tokens[m_index].value();
+    if (first.is_of_type<Token::Type::EndObject>() ||
+        first.is_of_type<Token::Type::EndArray>()) {
+      // There is no value to skip, end token stays
+      return false;
+    }
+    const bool is_object = first.is_of_type<Token::Type::StartObject>();
+    const bool is_array = first.is_of_type<Token::Type::StartArray>();
+    // Value is peeked, so its first token is already seen by on_advance
+    const bool is_peeked = m_advanced > m_index;
+
+    size_t index = m_index;
+    size_t depth = 0;
+    do {
+      if (index == m_tokens.size()) {
+        return false;
+      }
+
+      const auto &token = m_tokens[index++].value();
+      if (token.is_of_type<Token::Type::StartObject>() ||
+          token.is_of_type<Token::Type::StartArray>()) {
+        ++depth;
+      } else if (token.is_of_type<Token::Type::EndObject>() ||
+                 token.is_of_type<Token::Type::EndArray>()) {
+        --depth;
+      }
+    } while (depth > 0);
+    m_index = index;
+    m_advanced = index;
+
+    if (!is_peeked) {
+      m_path.value();
+    } else if (is_object) {
+      m_path.end_object();
+    } else if (is_array) {
+      m_path.end_array();
+    }
+
+    return true;
+  }
+
+  /**
+   * @return current path in json
+   */
+  std::optional<std::string> get_path() const {
+    return m_path.render(m_prefix());
+  }
+
+private:
+  /**
+   * @brief Update path on first access to current token
+   */
+  void on_advance() {
+    if (m_advanced > m_index) {
+      return;
+    }
+    m_advanced = m_index + 1;
+
+    const auto &token = m_tokens[m_index].value();
+    if (token.is_of_type<Token::Type::StartObject>()) {
+      m_path.start_object();
+    } else if (token.is_of_type<Token::Type::Key>()) {
+      m_path.key(token.value<Token::Type::Key>());
+    } else if (token.is_of_type<Token::Type::EndObject>()) {
+      m_path.end_object();
+    } else if (token.is_of_type<Token::Type::StartArray>()) {
+      m_path.start_array();
+    } else if (token.is_of_type<Token::Type::EndArray>()) {
+      m_path.end_array();
+    } else {
+      m_path.value();
+    }
+  }
+
+private:
+  Buffer &m_tokens;
+  std::function<std::string()> m_prefix;
+  std::pmr::memory_resource *m_resource;
+
+  size_t m_index = 0;
+  size_t m_advanced = 0;
+  Path m_path;
+
+  const std::optional<Token> m_end = std::nullopt;
+};
+
+} // namespace ctjson::detail
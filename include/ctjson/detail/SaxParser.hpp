@@ -0,0 +1,424 @@
+#pragma once
+
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <ctjson/Deserializable.hpp>
+#include <ctjson/Deserializer.hpp>
+#include <ctjson/ParseResult.hpp>
+
+#include <ctjson/detail/Convert.hpp>
+#include <ctjson/detail/Path.hpp>
+#include <ctjson/detail/ReplayTokenStream.hpp>
+#include <ctjson/detail/Token.hpp>
+#include <ctjson/detail/Typing.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Result of feeding one event to push parser
+ */
+enum class SaxStatus {
+  Continue, // Value is not complete yet
+  Done,     // Value is complete, event was consumed
+  Error,    // Error was stored in SaxContext
+};
+
+/**
+ * @brief State shared by all push parsers of one document
+ */
+struct SaxContext {
+  // Renders current path in json, called only on error
+  std::function<std::string()> path;
+  // Memory resource for parsed values
+  std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+  // First error encountered
+  std::optional<ParseResult<void>> error = std::nullopt;
+
+  /**
+   * @brief Store parse error, parsers stop at error, so path is rendered
+   * on request
+   */
+  SaxStatus fail(ParseResult<void>::Error parse_error) {
+    error.emplace(ParseResult<void>::parse_error(std::move(parse_error)));
+    return SaxStatus::Error;
+  }
+
+  /**
+   * @brief Store error of nested result
+   * @pre result.is_ok() == false
+   */
+  template <typename U>
+  SaxStatus fail(ParseResult<U> &&result) {
+    error.emplace(ParseResult<void>::convert_error(std::move(result)));
+    return SaxStatus::Error;
+  }
+};
+
+/**
+ * @return true if @ref type is one of tokens holding json value
+ */
+constexpr bool is_value_token(const TokenType type) {
+  return type == TokenType::Bool || type == TokenType::Int ||
+         type == TokenType::Uint || type == TokenType::Int64 ||
+         type == TokenType::Uint64 || type == TokenType::Double ||
+         type == TokenType::RawNumber || type == TokenType::String;
+}
+
+/**
+ * @brief Push parser of value of type T, fed with parser events one by one
+ *
+ * Specializations implement:
+ * - `void begin(T &target, SaxContext &context)` - start parsing new value
+ * - `template <TokenType t_type, typename... V> SaxStatus on(V &&...value)` -
+ *   feed event with its payload
+ * - `void render_path(std::string &path) const` - append path of current
+ *   event inside value
+ */
+template <typename T, typename Enable = void>
+class SaxParser;
+
+/**
+ * @brief Specialization for values: numbers and strings (numbers,
+ * std::string)
+ */
+template <typename T>
+class SaxParser<T, std::enable_if_t<is_json_value<T>>> {
+  static_assert(!std::is_same_v<T, std::string_view>,
+                "std::string_view is not supported by push parser, strings "
+                "are not owned by parser events");
+
+public:
+  void begin(T &target, SaxContext &context) {
+    m_target = &target;
+    m_context = &context;
+  }
+
+  template <TokenType t_type, typename... V>
+  SaxStatus on(V &&...value) {
+    if constexpr (is_value_token(t_type)) {
+      switch (convert_value(*m_target, std::forward<V>(value)...)) {
+      case Conversion::Ok:
+        return SaxStatus::Done;
+      case Conversion::OutOfRange:
+        return m_context->fail({.code = ErrorCode::OutOfRange});
+      case Conversion::Mismatch:
+        break;
+      }
+    }
+
+    // TODO: Provide better error
+    return m_context->fail(Deserializer::unexpected_type_error<t_type>());
+  }
+
+  void render_path(std::string &path) const {}
+
+private:
+  T *m_target = nullptr;
+  SaxContext *m_context = nullptr;
+};
+
+/**
+ * @brief Specialization for optional: null or T (std::optional<T>)
+ */
+template <typename T>
+class SaxParser<T, std::enable_if_t<is_optional_v<T>>> {
+  using ValueType = typename T::value_type;
+
+public:
+  void begin(T &target, SaxContext &context) {
+    m_target = &target;
+    m_context = &context;
+    m_started = false;
+  }
+
+  template <TokenType t_type, typename... V>
+  SaxStatus on(V &&...value) {
+    if (!m_started) {
+      if constexpr (t_type == TokenType::Null) {
+        m_target->reset();
+        return SaxStatus::Done;
+      } else {
+        m_started = true;
+        m_child.begin(
+            m_target->emplace(make_value<ValueType>(m_context->resource)),
+            *m_context);
+      }
+    }
+
+    return m_child.template on<t_type>(std::forward<V>(value)...);
+  }
+
+  void render_path(std::string &path) const {
+    if (m_started) {
+      m_child.render_path(path);
+    }
+  }
+
+private:
+  T *m_target = nullptr;
+  SaxContext *m_context = nullptr;
+  bool m_started = false;
+  SaxParser<ValueType> m_child;
+};
+
+/**
+ * @brief Specialization for arrays (std::vector, std::set,
+ * std::unordered_set)
+ */
+template <typename T>
+class SaxParser<T, std::enable_if_t<is_array_like_v<T>>> {
+  using ValueType = typename T::value_type;
+
+  enum class State { Initial, Elements, Element };
+
+public:
+  void begin(T &target, SaxContext &context) {
+    m_target = &target;
+    m_context = &context;
+    m_state = State::Initial;
+    m_count = 0;
+  }
+
+  template <TokenType t_type, typename... V>
+  SaxStatus on(V &&...value) {
+    if (m_state == State::Element) {
+      const auto status =
+          m_child.template on<t_type>(std::forward<V>(value)...);
+      if (status != SaxStatus::Done) {
+        return status;
+      }
+
+      is_array_like<T>::emplace(*m_target, std::move(m_element).value());
+      m_state = State::Elements;
+      return SaxStatus::Continue;
+    }
+
+    if (m_state == State::Initial) {
+      if constexpr (t_type == TokenType::StartArray) {
+        m_target->clear();
+        m_state = State::Elements;
+        return SaxStatus::Continue;
+      } else {
+        return m_context->fail(
+            Deserializer::unexpected_type_error<t_type,
+                                                TokenType::StartArray>());
+      }
+    }
+
+    if constexpr (t_type == TokenType::EndArray) {
+      return SaxStatus::Done;
+    } else {
+      // Constructed in place, since assignment keeps allocator of target
+      m_child.begin(
+          m_element.emplace(make_value<ValueType>(m_context->resource)),
+          *m_context);
+      m_state = State::Element;
+      ++m_count;
+
+      return on<t_type>(std::forward<V>(value)...);
+    }
+  }
+
+  void render_path(std::string &path) const {
+    if (m_state == State::Element) {
+      path += "[" + std::to_string(m_count - 1) + "]";
+      m_child.render_path(path);
+    }
+  }
+
+private:
+  T *m_target = nullptr;
+  SaxContext *m_context = nullptr;
+  State m_state = State::Initial;
+  size_t m_count = 0;
+  std::optional<ValueType> m_element = std::nullopt;
+  SaxParser<ValueType> m_child;
+};
+
+/**
+ * @brief Specialization for dicts (std::map<std::string, ...>,
+ * std::unordered_map<std::string, ...>)
+ */
+template <typename T>
+class SaxParser<T, std::enable_if_t<is_dict_like_v<T>>> {
+  using ValueType = typename T::mapped_type;
+
+  enum class State { Initial, Keys, Value };
+
+public:
+  void begin(T &target, SaxContext &context) {
+    m_target = &target;
+    m_context = &context;
+    m_state = State::Initial;
+  }
+
+  template <TokenType t_type, typename... V>
+  SaxStatus on(V &&...value) {
+    if (m_state == State::Value) {
+      const auto status =
+          m_child.template on<t_type>(std::forward<V>(value)...);
+      if (status != SaxStatus::Done) {
+        return status;
+      }
+
+      is_dict_like<T>::emplace(*m_target, std::move(m_key),
+                               std::move(m_value).value());
+      m_state = State::Keys;
+      return SaxStatus::Continue;
+    }
+
+    if (m_state == State::Initial) {
+      if constexpr (t_type == TokenType::StartObject) {
+        m_target->clear();
+        m_state = State::Keys;
+        return SaxStatus::Continue;
+      } else {
+        return m_context->fail(
+            Deserializer::unexpected_type_error<t_type,
+                                                TokenType::StartObject>());
+      }
+    }
+
+    if constexpr (t_type == TokenType::EndObject) {
+      return SaxStatus::Done;
+    } else if constexpr (t_type == TokenType::Key) {
+      m_key.assign(std::string_view(value...));
+      // Constructed in place, since assignment keeps allocator of target
+      m_child.begin(m_value.emplace(make_value<ValueType>(m_context->resource)),
+                    *m_context);
+      m_state = State::Value;
+      return SaxStatus::Continue;
+    } else {
+      return m_context->fail(
+          Deserializer::unexpected_type_error<t_type, TokenType::Key,
+                                              TokenType::EndObject>());
+    }
+  }
+
+  void render_path(std::string &path) const {
+    if (m_state == State::Value) {
+      path += "." + m_key;
+      m_child.render_path(path);
+    }
+  }
+
+private:
+  T *m_target = nullptr;
+  SaxContext *m_context = nullptr;
+  State m_state = State::Initial;
+  std::string m_key;
+  std::optional<ValueType> m_value = std::nullopt;
+  SaxParser<ValueType> m_child;
+};
+
+/**
+ * @brief Is @tparam T parsed by its own pull deserialization (json_parse,
+ * json_parse_into or Deserializable)
+ */
+template <typename T>
+constexpr bool is_replayed_v =
+    has_parse_v<T, ParseResult<T>, ReplayTokenStream &> ||
+    has_parse_into_v<T, ParseResult<void>, T &, ReplayTokenStream &> ||
+    Deserializable<T, ReplayTokenStream>::value;
+
+/**
+ * @brief Specialization for classes that implement json_parse,
+ * json_parse_into or have Deserializable instantiated
+ *
+ * Events of the value are buffered as tokens and replayed through pull
+ * deserialization once the value is complete
+ */
+template <typename T>
+class SaxParser<T, std::enable_if_t<is_replayed_v<T>>> {
+public:
+  void begin(T &target, SaxContext &context) {
+    m_target = &target;
+    m_context = &context;
+    m_tokens.clear();
+    m_depth = 0;
+    m_path = Path();
+    m_replaying = false;
+  }
+
+  template <TokenType t_type, typename... V>
+  SaxStatus on(V &&...value) {
+    m_tokens.emplace_back(Token::create<t_type>(owned(value)...));
+    track<t_type>(value...);
+
+    if (m_depth > 0) {
+      return SaxStatus::Continue;
+    }
+
+    m_replaying = true;
+    ReplayTokenStream tokens(
+        m_tokens, [this]() { return m_context->path(); }, m_context->resource);
+    auto result = Deserializer::parse<T>(tokens);
+    m_replaying = false;
+
+    if (!result.is_ok()) {
+      return m_context->fail(std::move(result));
+    }
+
+    *m_target = std::move(result).value();
+    return SaxStatus::Done;
+  }
+
+  void render_path(std::string &path) const {
+    if (!m_replaying) {
+      path = m_path.render(std::move(path));
+    }
+  }
+
+private:
+  /**
+   * @brief Copy strings referencing parser buffer
+   */
+  template <typename V>
+  static V owned(const V &value) {
+    return value;
+  }
+
+  static std::string owned(const std::string_view value) {
+    return std::string(value);
+  }
+
+  /**
+   * @brief Track nesting and path of buffered events
+   */
+  template <TokenType t_type, typename... V>
+  void track(const V &...value) {
+    if constexpr (t_type == TokenType::StartObject) {
+      ++m_depth;
+      m_path.start_object();
+    } else if constexpr (t_type == TokenType::Key) {
+      m_path.key(value...);
+    } else if constexpr (t_type == TokenType::EndObject) {
+      --m_depth;
+      m_path.end_object();
+    } else if constexpr (t_type == TokenType::StartArray) {
+      ++m_depth;
+      m_path.start_array();
+    } else if constexpr (t_type == TokenType::EndArray) {
+      --m_depth;
+      m_path.end_array();
+    } else {
+      m_path.value();
+    }
+  }
+
+private:
+  T *m_target = nullptr;
+  SaxContext *m_context = nullptr;
+  ReplayTokenStream::Buffer m_tokens;
+  size_t m_depth = 0;
+  Path m_path;
+  bool m_replaying = false;
+};
+
+} // namespace ctjson::detail
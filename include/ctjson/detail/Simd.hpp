@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * @brief SIMD support
+ *
+ * SSE2 is used when enabled at compile time (always on x86-64). AVX2 code is
+ * compiled for x86-64 with GCC or Clang and selected at runtime if CPU
+ * supports it, @see has_avx2
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define CTJSON_AVX2_DISPATCH
+#endif
+
+namespace ctjson::detail {
+
+#if defined(CTJSON_AVX2_DISPATCH)
+/**
+ * @return true if CPU supports AVX2, checked once
+ */
+inline bool has_avx2() {
+  static const bool result = __builtin_cpu_supports("avx2");
+  return result;
+}
+#endif
+
+} // namespace ctjson::detail
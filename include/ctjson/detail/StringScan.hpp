@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ctjson/detail/Simd.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @return true if byte needs escaping in json string: quote, backslash or
+ * control character
+ */
+constexpr bool needs_escape(const unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+/**
+ * @brief Find first byte that needs escaping, or is not ASCII if
+ * @ref stop_on_non_ascii, one byte at a time
+ *
+ * @return index of found byte or @ref size if there is no such byte
+ */
+inline size_t find_special_scalar(const char *data, const size_t size,
+                                  const bool stop_on_non_ascii) {
+  for (size_t i = 0; i < size; ++i) {
+    const auto c = static_cast<unsigned char>(data[i]);
+    if (needs_escape(c) || (stop_on_non_ascii && c >= 0x80)) {
+      return i;
+    }
+  }
+
+  return size;
+}
+
+#if defined(__SSE2__)
+/**
+ * @brief Find first special byte 16 bytes at a time, @see find_special_scalar
+ */
+inline size_t find_special_sse2(const char *data, const size_t size,
+                                const bool stop_on_non_ascii) {
+  const auto quote = _mm_set1_epi8('"');
+  const auto backslash = _mm_set1_epi8('\\');
+  const auto control = _mm_set1_epi8(0x1F);
+  // High bit of each byte is checked by movemask
+  const auto ascii =
+      stop_on_non_ascii ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    // Unsigned c <= 0x1F if max(c, 0x1F) == 0x1F
+    auto special = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control);
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, quote));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, backslash));
+    special = _mm_or_si128(special, _mm_and_si128(chunk, ascii));
+
+    const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+
+  return i + find_special_scalar(data + i, size - i, stop_on_non_ascii);
+}
+#endif
+
+#if defined(CTJSON_AVX2_DISPATCH)
+/**
+ * @brief Find first special byte 32 bytes at a time, @see find_special_scalar
+ */
+__attribute__((target("avx2"))) inline size_t
+find_special_avx2(const char *data, const size_t size,
+                  const bool stop_on_non_ascii) {
+  const auto quote = _mm256_set1_epi8('"');
+  const auto backslash = _mm256_set1_epi8('\\');
+  const auto control = _mm256_set1_epi8(0x1F);
+  const auto ascii =
+      stop_on_non_ascii ? _mm256_set1_epi8(-1) : _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const auto chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    auto special =
+        _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control);
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, quote));
+    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, backslash));
+    special = _mm256_or_si256(special, _mm256_and_si256(chunk, ascii));
+
+    const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+
+  return i + find_special_sse2(data + i, size - i, stop_on_non_ascii);
+}
+#endif
+
+/**
+ * @brief Find first byte that needs escaping, or is not ASCII if
+ * @ref stop_on_non_ascii
+ *
+ * Uses AVX2 if CPU supports it, SSE2 or scalar loop otherwise.
+ * @param data bytes to scan
+ * @param size number of bytes
+ * @param stop_on_non_ascii stop on bytes >= 0x80 too
+ * @return index of found byte or @ref size if there is no such byte
+ */
+inline size_t find_special(const char *data, const size_t size,
+                           const bool stop_on_non_ascii) {
+#if defined(CTJSON_AVX2_DISPATCH)
+  if (has_avx2()) {
+    return find_special_avx2(data, size, stop_on_non_ascii);
+  }
+#endif
+#if defined(__SSE2__)
+  return find_special_sse2(data, size, stop_on_non_ascii);
+#else
+  return find_special_scalar(data, size, stop_on_non_ascii);
+#endif
+}
+
+/**
+ * @brief Check UTF-8 sequence starting with non-ASCII byte
+ *
+ * @param data sequence
+ * @param size number of available bytes
+ * @return size of valid sequence, 0 if sequence is invalid
+ */
+inline size_t utf8_sequence_size(const char *data, const size_t size) {
+  const auto byte = [data](const size_t i) {
+    return static_cast<unsigned char>(data[i]);
+  };
+  const auto in = [](const unsigned char c, const unsigned char low,
+                     const unsigned char high) {
+    return c >= low && c <= high;
+  };
+
+  const auto lead = byte(0);
+  if (in(lead, 0xC2, 0xDF)) {
+    return size >= 2 && in(byte(1), 0x80, 0xBF) ? 2 : 0;
+  }
+
+  // Allowed range of second byte depends on lead byte
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  size_t length = 0;
+  if (in(lead, 0xE0, 0xEF)) {
+    length = 3;
+    low = lead == 0xE0 ? 0xA0 : 0x80;  // Overlong
+    high = lead == 0xED ? 0x9F : 0xBF; // Surrogates
+  } else if (in(lead, 0xF0, 0xF4)) {
+    length = 4;
+    low = lead == 0xF0 ? 0x90 : 0x80;  // Overlong
+    high = lead == 0xF4 ? 0x8F : 0xBF; // Above U+10FFFF
+  } else {
+    return 0;
+  }
+
+  if (size < length || !in(byte(1), low, high)) {
+    return 0;
+  }
+  for (size_t i = 2; i < length; ++i) {
+    if (!in(byte(i), 0x80, 0xBF)) {
+      return 0;
+    }
+  }
+
+  return length;
+}
+
+} // namespace ctjson::detail
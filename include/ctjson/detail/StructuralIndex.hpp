@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <ctjson/detail/Simd.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Bit masks of characters of interest in 64-byte block, bit i is set
+ * if byte i of block is of given class
+ */
+struct BlockMasks {
+  uint64_t backslash = 0;
+  uint64_t quote = 0;
+  // Braces, brackets, colon and comma
+  uint64_t op = 0;
+  // Space, tab, line feed and carriage return
+  uint64_t whitespace = 0;
+};
+
+/**
+ * @brief Classify 64 bytes one byte at a time
+ */
+inline BlockMasks classify_block_scalar(const char *block) {
+  BlockMasks masks;
+  for (size_t i = 0; i < 64; ++i) {
+    const uint64_t bit = uint64_t{1} << i;
+    switch (block[i]) {
+    case '\\':
+      masks.backslash |= bit;
+      break;
+    case '"':
+      masks.quote |= bit;
+      break;
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+      masks.op |= bit;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      masks.whitespace |= bit;
+      break;
+    default:
+      break;
+    }
+  }
+
+  return masks;
+}
+
+#if defined(__SSE2__)
+/**
+ * @return mask of bytes of 16-byte @ref chunk equal to any of @ref chars
+ */
+template <typename... Chars>
+inline uint64_t match_sse2(const __m128i chunk, const Chars... chars) {
+  __m128i result = _mm_setzero_si128();
+  ((result = _mm_or_si128(result,
+                          _mm_cmpeq_epi8(chunk, _mm_set1_epi8(chars)))),
+   ...);
+
+  return static_cast<uint16_t>(_mm_movemask_epi8(result));
+}
+
+/**
+ * @brief Classify 64 bytes 16 bytes at a time
+ */
+inline BlockMasks classify_block_sse2(const char *block) {
+  BlockMasks masks;
+  for (size_t i = 0; i < 4; ++i) {
+    const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+    const auto shift = 16 * i;
+    masks.backslash |= match_sse2(chunk, '\\') << shift;
+    masks.quote |= match_sse2(chunk, '"') << shift;
+    masks.op |= match_sse2(chunk, '{', '}', '[', ']', ':', ',') << shift;
+    masks.whitespace |= match_sse2(chunk, ' ', '\t', '\n', '\r') << shift;
+  }
+
+  return masks;
+}
+#endif
+
+#if defined(CTJSON_AVX2_DISPATCH)
+/**
+ * @return mask of bytes of 32-byte @ref chunk equal to any of @ref chars
+ */
+template <typename... Chars>
+__attribute__((target("avx2"))) inline uint64_t
+match_avx2(const __m256i chunk, const Chars... chars) {
+  __m256i result = _mm256_setzero_si256();
+  ((result = _mm256_or_si256(
+        result, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(chars)))),
+   ...);
+
+  return static_cast<uint32_t>(_mm256_movemask_epi8(result));
+}
+
+/**
+ * @brief Classify 64 bytes 32 bytes at a time
+ */
+__attribute__((target("avx2"))) inline BlockMasks
+classify_block_avx2(const char *block) {
+  BlockMasks masks;
+  for (size_t i = 0; i < 2; ++i) {
+    const auto chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32 * i));
+    const auto shift = 32 * i;
+    masks.backslash |= match_avx2(chunk, '\\') << shift;
+    masks.quote |= match_avx2(chunk, '"') << shift;
+    masks.op |= match_avx2(chunk, '{', '}', '[', ']', ':', ',') << shift;
+    masks.whitespace |= match_avx2(chunk, ' ', '\t', '\n', '\r') << shift;
+  }
+
+  return masks;
+}
+#endif
+
+/**
+ * @brief Classify 64 bytes, using AVX2 if CPU supports it, SSE2 or scalar
+ * loop otherwise
+ */
+inline BlockMasks classify_block(const char *block) {
+#if defined(CTJSON_AVX2_DISPATCH)
+  if (has_avx2()) {
+    return classify_block_avx2(block);
+  }
+#endif
+#if defined(__SSE2__)
+  return classify_block_sse2(block);
+#else
+  return classify_block_scalar(block);
+#endif
+}
+
+/**
+ * @return mask of bytes escaped by backslash: preceded by odd-length run of
+ * backslashes
+ *
+ * @param backslash mask of backslashes in block
+ * @param prev_escaped first byte of block is escaped, updated for next block
+ */
+inline uint64_t find_escaped(uint64_t backslash, uint64_t &prev_escaped) {
+  constexpr uint64_t even_bits = 0x5555555555555555ULL;
+
+  // Escaped backslash does not escape
+  backslash &= ~prev_escaped;
+  const uint64_t follows_escape = backslash << 1 | prev_escaped;
+  // Runs of backslashes starting on odd positions
+  const uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+  // Adding run starts to runs carries past ends of runs
+  uint64_t ends_of_odd_starts = odd_starts + backslash;
+  const bool overflow = ends_of_odd_starts < odd_starts;
+  prev_escaped = overflow ? 1 : 0;
+  // Run ends on even position if it started on odd one and its length is odd
+  const uint64_t invert_mask = ends_of_odd_starts << 1;
+
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+/**
+ * @return mask of bits between each pair of set bits of @ref mask,
+ * including first of pair
+ */
+inline uint64_t prefix_xor(uint64_t mask) {
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+
+  return mask;
+}
+
+/**
+ * @brief Build structural index: positions of braces, brackets, colons and
+ * commas outside strings, opening quotes of strings and first bytes of other
+ * scalars (numbers and literals)
+ *
+ * Input is processed in blocks of 64 bytes: characters are classified with
+ * SIMD, then strings are found with bit operations, without branching on
+ * each byte.
+ * @param json input
+ * @param index output positions, in increasing order
+ * @return false if input ends inside string
+ */
+inline bool build_structural_index(const std::string_view json,
+                                   std::vector<uint32_t> &index) {
+  index.clear();
+
+  uint64_t prev_escaped = 0;
+  uint64_t prev_in_string = 0; // All ones if previous block ends in string
+  uint64_t prev_scalar = 0;
+  const auto process = [&](const char *block, const size_t offset) {
+    const auto masks = classify_block(block);
+
+    const uint64_t escaped = find_escaped(masks.backslash, prev_escaped);
+    const uint64_t quote = masks.quote & ~escaped;
+    // Opening quote and string contents, but not closing quote
+    const uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+    prev_in_string =
+        static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+    const uint64_t scalar =
+        ~(masks.op | masks.whitespace | masks.quote) & ~in_string;
+    const uint64_t follows_scalar = scalar << 1 | prev_scalar;
+    prev_scalar = scalar >> 63;
+
+    uint64_t structural = (masks.op & ~in_string) |
+                          (scalar & ~follows_scalar) | (quote & in_string);
+    while (structural != 0) {
+      index.push_back(
+          static_cast<uint32_t>(offset + __builtin_ctzll(structural)));
+      structural &= structural - 1;
+    }
+  };
+
+  size_t offset = 0;
+  for (; offset + 64 <= json.size(); offset += 64) {
+    process(json.data() + offset, offset);
+  }
+  if (offset < json.size()) {
+    // Last block is padded with whitespace
+    char block[64];
+    std::memset(block, ' ', sizeof(block));
+    std::memcpy(block, json.data() + offset, json.size() - offset);
+    process(block, offset);
+  }
+
+  return prev_in_string == 0;
+}
+
+} // namespace ctjson::detail
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ctjson/detail/Token.hpp>
+
+namespace ctjson::detail {
+
+/**
+ * @brief Json document tokenized to flat array of 64-bit words
+ *
+ * Each token starts with one word: type in the high byte, payload in the low
+ * 56 bits. Payload is:
+ * - Bool, Int, Uint: value, Int is stored as its 32-bit two's complement
+ * - Int64, Uint64, Double: unused, value is stored in the next word
+ * - String, Key, RawNumber: offset of string in string buffer, its size is
+ *   stored in the next word
+ * - StartObject, StartArray: index of word of matching end token, 0 if
+ *   container is not closed, so containers are skipped in one step
+ * - EndObject, EndArray: number of members or elements
+ *
+ * Decoded strings of all tokens are stored in one buffer, so tokenizing does
+ * not allocate per token. Words and strings keep capacity on clear.
+ */
+class Tape {
+public:
+  using Word = uint64_t;
+
+  // Shift of token type in word
+  constexpr static unsigned type_shift = 56;
+  // Mask of payload in word
+  constexpr static Word payload_mask = (Word{1} << type_shift) - 1;
+
+public:
+  /**
+   * @return number of words
+   */
+  size_t size() const { return m_words.size(); }
+
+  /**
+   * @return true if there are no tokens
+   */
+  bool empty() const { return m_words.empty(); }
+
+  /**
+   * @brief Drop all tokens, keeping capacity
+   */
+  void clear() {
+    m_words.clear();
+    m_strings.clear();
+  }
+
+  /**
+   * @return type of token starting at word @ref index
+   */
+  TokenType type(const size_t index) const {
+    return static_cast<TokenType>(m_words[index] >> type_shift);
+  }
+
+  /**
+   * @return payload of token starting at word @ref index
+   */
+  Word payload(const size_t index) const {
+    return m_words[index] & payload_mask;
+  }
+
+  /**
+   * @return value of Int64, Uint64 or Double token at word @ref index
+   */
+  template <typename T>
+  T value(const size_t index) const {
+    T result;
+    std::memcpy(&result, &m_words[index + 1], sizeof(result));
+
+    return result;
+  }
+
+  /**
+   * @return string of String, Key or RawNumber token at word @ref index,
+   * valid until tape is modified
+   */
+  std::string_view string(const size_t index) const {
+    return std::string_view(m_strings).substr(payload(index),
+                                              m_words[index + 1]);
+  }
+
+  /**
+   * @return index of word of token following token at @ref index, for
+   * containers it is the first token inside
+   */
+  size_t next(const size_t index) const {
+    switch (type(index)) {
+    case TokenType::Int64:
+    case TokenType::Uint64:
+    case TokenType::Double:
+    case TokenType::RawNumber:
+    case TokenType::String:
+    case TokenType::Key:
+      return index + 2;
+    default:
+      return index + 1;
+    }
+  }
+
+  /**
+   * @return index of word following the whole value starting at @ref index,
+   * size() if value is not complete
+   */
+  size_t skip(const size_t index) const {
+    const auto t_type = type(index);
+    if (t_type != TokenType::StartObject && t_type != TokenType::StartArray) {
+      return next(index);
+    }
+
+    const auto end = payload(index);
+    return end == 0 ? size() : end + 1;
+  }
+
+  /**
+   * @brief Append token without value word
+   */
+  void push(const TokenType t_type, const Word payload = 0) {
+    m_words.push_back(static_cast<Word>(t_type) << type_shift |
+                      (payload & payload_mask));
+  }
+
+  /**
+   * @brief Append token with value word
+   */
+  template <typename T>
+  void push_value(const TokenType t_type, const T value) {
+    static_assert(sizeof(T) == sizeof(Word));
+
+    push(t_type);
+    Word word;
+    std::memcpy(&word, &value, sizeof(word));
+    m_words.push_back(word);
+  }
+
+  /**
+   * @brief Append token with string, copying it to string buffer
+   */
+  void push_string(const TokenType t_type, const std::string_view value) {
+    push(t_type, m_strings.size());
+    m_words.push_back(value.size());
+    m_strings.append(value);
+  }
+
+  /**
+   * @brief Set index of matching end token of container at @ref index to
+   * the last word
+   */
+  void close(const size_t index) {
+    m_words[index] = (m_words[index] & ~payload_mask) | (size() - 1);
+  }
+
+private:
+  std::vector<Word> m_words;
+  std::string m_strings;
+};
+
+/**
+ * @brief Class implementing Handler concept from rapidjson to write tokens
+ * to tape
+ */
+class TapeBuilder {
+public:
+  /**
+   * @param tape tape to append tokens to
+   */
+  explicit TapeBuilder(Tape &tape) : m_tape(tape) {}
+
+  bool Null() { return push(TokenType::Null); }
+  bool Bool(bool boolean) { return push(TokenType::Bool, boolean); }
+  bool Int(int integer) {
+    return push(TokenType::Int, static_cast<uint32_t>(integer));
+  }
+  bool Uint(unsigned integer) { return push(TokenType::Uint, integer); }
+  bool Int64(int64_t integer) {
+    m_tape.push_value(TokenType::Int64, integer);
+    return true;
+  }
+  bool Uint64(uint64_t integer) {
+    m_tape.push_value(TokenType::Uint64, integer);
+    return true;
+  }
+  bool Double(double number) {
+    m_tape.push_value(TokenType::Double, number);
+    return true;
+  }
+  bool RawNumber(const char *str, unsigned len, bool copy) {
+    m_tape.push_string(TokenType::RawNumber, std::string_view(str, len));
+    return true;
+  }
+  bool String(const char *str, unsigned len, bool copy) {
+    m_tape.push_string(TokenType::String, std::string_view(str, len));
+    return true;
+  }
+  bool StartObject() { return start(TokenType::StartObject); }
+  bool Key(const char *str, unsigned len, bool copy) {
+    m_tape.push_string(TokenType::Key, std::string_view(str, len));
+    return true;
+  }
+  bool EndObject(unsigned size) { return end(TokenType::EndObject, size); }
+  bool StartArray() { return start(TokenType::StartArray); }
+  bool EndArray(unsigned size) { return end(TokenType::EndArray, size); }
+
+private:
+  bool push(const TokenType t_type, const Tape::Word payload = 0) {
+    m_tape.push(t_type, payload);
+    return true;
+  }
+
+  bool start(const TokenType t_type) {
+    m_open.push_back(m_tape.size());
+    return push(t_type);
+  }
+
+  bool end(const TokenType t_type, const unsigned size) {
+    push(t_type, size);
+    m_tape.close(m_open.back());
+    m_open.pop_back();
+
+    return true;
+  }
+
+private:
+  Tape &m_tape;
+  // Indices of start tokens of open containers
+  std::vector<size_t> m_open;
+};
+
+} // namespace ctjson::detail
@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace ctjson::detail {
@@ -27,6 +29,54 @@ enum class TokenType {
   EndArray,
 };
 
+// Set of token types, bit i stands for type with value i
+using TokenMask = uint16_t;
+
+/**
+ * @return set containing only @ref t_type
+ */
+constexpr TokenMask token_mask(const TokenType t_type) {
+  return static_cast<TokenMask>(1u << static_cast<unsigned>(t_type));
+}
+
+/**
+ * @return name of token of type @ref t_type
+ */
+constexpr std::string_view token_name(const TokenType t_type) {
+  switch (t_type) {
+  case TokenType::Null:
+    return "null";
+  case TokenType::Bool:
+    return "bool";
+  case TokenType::Int:
+    return "int";
+  case TokenType::Uint:
+    return "uint";
+  case TokenType::Int64:
+    return "int64";
+  case TokenType::Uint64:
+    return "uint64";
+  case TokenType::Double:
+    return "double";
+  case TokenType::RawNumber:
+    return "number";
+  case TokenType::String:
+    return "string";
+  case TokenType::StartObject:
+    return "start object";
+  case TokenType::Key:
+    return "key";
+  case TokenType::EndObject:
+    return "end object";
+  case TokenType::StartArray:
+    return "start array";
+  case TokenType::EndArray:
+    return "end array";
+  }
+
+  return "unknown";
+}
+
 /**
  * @brief Template base to optionally add value to Token
  *
@@ -66,14 +116,23 @@ using UintToken = ExactToken<TokenType::Uint, unsigned>;
 using Int64Token = ExactToken<TokenType::Int64, int64_t>;
 using Uint64Token = ExactToken<TokenType::Uint64, uint64_t>;
 using DoubleToken = ExactToken<TokenType::Double, double>;
-using NumberToken = ExactToken<TokenType::RawNumber, std::string>;
-using StringToken = ExactToken<TokenType::String, std::string>;
 using StartObjectToken = ExactToken<TokenType::StartObject>;
-using KeyToken = ExactToken<TokenType::Key, std::string>;
 using EndObjectToken = ExactToken<TokenType::EndObject, unsigned>;
 using StartArrayToken = ExactToken<TokenType::StartArray>;
 using EndArrayToken = ExactToken<TokenType::EndArray, unsigned>;
 
+// Tokens holding strings, parametrized by string type
+template <typename String>
+using BasicNumberToken = ExactToken<TokenType::RawNumber, String>;
+template <typename String>
+using BasicStringToken = ExactToken<TokenType::String, String>;
+template <typename String>
+using BasicKeyToken = ExactToken<TokenType::Key, String>;
+
+using NumberToken = BasicNumberToken<std::string>;
+using StringToken = BasicStringToken<std::string>;
+using KeyToken = BasicKeyToken<std::string>;
+
 /**
  * @brief Template magic to find token of given type
  *
@@ -108,6 +167,10 @@ struct TokenList {
   template <TokenType t_type>
   using of_type = typename token_of_type<t_type, Tokens...>::type;
 
+  // Is token @tparam T in list
+  template <typename T>
+  constexpr static bool contains = (std::is_same_v<T, Tokens> || ...);
+
   /**
    * @brief Template utility to concatenate TokenLists
    */
@@ -125,26 +188,41 @@ template <typename L, typename R>
 using cat = typename L::template cat<R>::type;
 
 // Meta tokens
-using MetaTokens = TokenList<NullToken, StartObjectToken, KeyToken,
-                             EndObjectToken, StartArrayToken, EndArrayToken>;
+template <typename String>
+using BasicMetaTokens =
+    TokenList<NullToken, StartObjectToken, BasicKeyToken<String>,
+              EndObjectToken, StartArrayToken, EndArrayToken>;
 
 // Value tokens
-using ValueTokens =
+template <typename String>
+using BasicValueTokens =
     TokenList<BoolToken, IntToken, UintToken, Int64Token, Uint64Token,
-              DoubleToken, NumberToken, StringToken>;
+              DoubleToken, BasicNumberToken<String>, BasicStringToken<String>>;
 
 // All tokens
-using Tokens = cat<MetaTokens, ValueTokens>;
+template <typename String>
+using BasicTokens = cat<BasicMetaTokens<String>, BasicValueTokens<String>>;
+
+using MetaTokens = BasicMetaTokens<std::string>;
+using ValueTokens = BasicValueTokens<std::string>;
+using Tokens = BasicTokens<std::string>;
 
 /**
  * @brief Class representing polymorphic token
+ *
+ * @tparam String type of string held by string tokens (key, string, number),
+ * either std::string or std::string_view into input buffer
  */
-class Token {
+template <typename String>
+class BasicToken {
 private:
-  using TokenVariant = Tokens::Variant;
+  using Tokens = BasicTokens<String>;
+  using TokenVariant = typename Tokens::Variant;
 
 public:
   using Type = TokenType;
+  using string_type = String;
+  using ValueTokens = BasicValueTokens<String>;
 
 private:
   /**
@@ -153,7 +231,7 @@ private:
    * @param args arguments for variant constructor
    */
   template <typename T, typename... Args>
-  Token(std::in_place_type_t<T> tag, Args &&...args)
+  BasicToken(std::in_place_type_t<T> tag, Args &&...args)
       : m_token(tag, std::forward<Args>(args)...) {}
 
 public:
@@ -163,9 +241,9 @@ public:
    * @param args arguments for token constructor
    */
   template <Type t_type, typename... Args>
-  static Token create(Args &&...args) noexcept {
-    using ExactToken = Tokens::of_type<t_type>;
-    return Token(std::in_place_type<ExactToken>,
+  static BasicToken create(Args &&...args) noexcept {
+    using ExactToken = typename Tokens::template of_type<t_type>;
+    return BasicToken(std::in_place_type<ExactToken>,
                  ExactToken::create(std::forward<Args>(args)...));
   }
 
@@ -175,7 +253,7 @@ public:
    */
   template <Type t_type>
   bool is_of_type() const {
-    using ExactToken = Tokens::of_type<t_type>;
+    using ExactToken = typename Tokens::template of_type<t_type>;
     return std::holds_alternative<ExactToken>(m_token);
   }
 
@@ -186,7 +264,7 @@ public:
    */
   template <Type t_type>
   auto &value() {
-    using ExactToken = Tokens::of_type<t_type>;
+    using ExactToken = typename Tokens::template of_type<t_type>;
     return std::get<ExactToken>(m_token).value;
   }
 
@@ -197,61 +275,54 @@ public:
    */
   template <Type t_type>
   const auto &value() const {
-    using ExactToken = Tokens::of_type<t_type>;
+    using ExactToken = typename Tokens::template of_type<t_type>;
     return std::get<ExactToken>(m_token).value;
   }
 
+  /**
+   * @brief Call @ref visitor with exact token this contains, dispatching
+   * once on its type
+   *
+   * @param visitor callable accepting reference to any exact token
+   * @return result of @ref visitor
+   */
+  template <typename Visitor>
+  decltype(auto) visit(Visitor &&visitor) {
+    return std::visit(std::forward<Visitor>(visitor), m_token);
+  }
+
   /**
    * @tparam t_type type of token
    * @return name of token of type @ref t_type
    */
   template <Type t_type>
   static std::string name() noexcept {
-    if constexpr (t_type == Type::Null) {
-      return "null";
-    } else if constexpr (t_type == Type::Bool) {
-      return "bool";
-    } else if constexpr (t_type == Type::Int) {
-      return "int";
-    } else if constexpr (t_type == Type::Int64) {
-      return "int64";
-    } else if constexpr (t_type == Type::Uint) {
-      return "uint";
-    } else if constexpr (t_type == Type::Uint64) {
-      return "uint64";
-    } else if constexpr (t_type == Type::Double) {
-      return "double";
-    } else if constexpr (t_type == Type::RawNumber) {
-      return "number";
-    } else if constexpr (t_type == Type::String) {
-      return "string";
-    } else if constexpr (t_type == Type::StartObject) {
-      return "start object";
-    } else if constexpr (t_type == Type::Key) {
-      return "key";
-    } else if constexpr (t_type == Type::EndObject) {
-      return "end object";
-    } else if constexpr (t_type == Type::StartArray) {
-      return "start array";
-    } else if constexpr (t_type == Type::EndArray) {
-      return "end array";
-    } else {
-      static_assert(static_cast<int>(t_type) == -1, "Unknown token type");
-    }
+    return std::string(token_name(t_type));
   }
 
   /**
-   * @return name of token this contains
+   * @return type of token this contains
    */
-  std::string name() const {
+  Type type() const {
     return std::visit(
-        [&](const auto &arg) noexcept {
-          return Token::name<std::decay_t<decltype(arg)>::type>();
+        [](const auto &arg) noexcept {
+          return std::decay_t<decltype(arg)>::type;
         },
         m_token);
   }
 
+  /**
+   * @return name of token this contains
+   */
+  std::string name() const { return std::string(token_name(type())); }
+
 private:
   TokenVariant m_token;
 };
+
+// Token owning its strings
+using Token = BasicToken<std::string>;
+
+// Token referencing strings in input buffer (in-situ parsing)
+using TokenView = BasicToken<std::string_view>;
 } // namespace ctjson::detail
\ No newline at end of file
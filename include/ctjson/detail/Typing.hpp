@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <map>
+#include <memory_resource>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,12 +17,35 @@
 
 namespace ctjson::detail {
 
+template <typename T>
+struct is_string : std::false_type {};
+
+template <typename Alloc>
+struct is_string<std::basic_string<char, std::char_traits<char>, Alloc>>
+    : std::true_type {};
+
+template <>
+struct is_string<std::string_view> : std::true_type {};
+
+/**
+ * @brief Is @tparam T string (std::string with any allocator, e.g.
+ * std::pmr::string, or std::string_view)
+ */
+template <typename T>
+constexpr bool is_string_v = is_string<T>::value;
+
+/**
+ * @brief Is @tparam T owning string usable as key of dict
+ */
+template <typename T>
+constexpr bool is_key_string_v =
+    is_string_v<T> && !std::is_same_v<std::string_view, T>;
+
 /**
  * @brief Is @tparam T basic json value (number or string)
  */
 template <typename T>
-constexpr bool is_json_value =
-    std::is_arithmetic_v<T> || std::is_same_v<std::string, T>;
+constexpr bool is_json_value = std::is_arithmetic_v<T> || is_string_v<T>;
 
 template <typename T>
 struct is_optional : std::false_type {};
@@ -35,60 +62,91 @@ constexpr static bool is_optional_v = is_optional<T>::value;
 template <typename T>
 struct is_array_like : std::false_type {};
 
-template <typename T>
-struct is_array_like<std::vector<T>> : std::true_type {
+template <typename T, typename Alloc>
+struct is_array_like<std::vector<T, Alloc>> : std::true_type {
+  // Elements are indexed and could be parsed in place
+  constexpr static bool is_sequence = true;
+
   template <typename... Args>
-  static inline void emplace(std::vector<T> &v, Args &&...args) {
+  static inline void emplace(std::vector<T, Alloc> &v, Args &&...args) {
     v.emplace_back(std::forward<Args>(args)...);
   }
 };
 
-template <typename T>
-struct is_array_like<std::set<T>> : std::true_type {
+template <typename T, typename Compare, typename Alloc>
+struct is_array_like<std::set<T, Compare, Alloc>> : std::true_type {
+  // Elements are stored in nodes, @see std::set::extract
+  constexpr static bool is_sequence = false;
+
   template <typename... Args>
-  static inline void emplace(std::set<T> &s, Args &&...args) {
+  static inline void emplace(std::set<T, Compare, Alloc> &s, Args &&...args) {
     s.emplace(std::forward<Args>(args)...);
   }
 };
 
-template <typename T>
-struct is_array_like<std::unordered_set<T>> : std::true_type {
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+struct is_array_like<std::unordered_set<T, Hash, KeyEqual, Alloc>>
+    : std::true_type {
+  // Elements are stored in nodes, @see std::unordered_set::extract
+  constexpr static bool is_sequence = false;
+
   template <typename... Args>
-  static inline void emplace(std::unordered_set<T> &s, Args &&...args) {
+  static inline void emplace(std::unordered_set<T, Hash, KeyEqual, Alloc> &s,
+                             Args &&...args) {
     s.emplace(std::forward<Args>(args)...);
   }
 };
 
 /**
  * @brief Is @tparam T array like from some other type (std::vector, std::set,
- * std::unordered_set)
+ * std::unordered_set, with any allocator)
  */
 template <typename T>
 constexpr static bool is_array_like_v = is_array_like<T>::value;
 
 template <typename T>
-struct is_dict_like : std::false_type {};
+struct is_fixed_array : std::false_type {};
 
+template <typename T, size_t N>
+struct is_fixed_array<std::array<T, N>> : std::true_type {
+  constexpr static size_t size = N;
+};
+
+/**
+ * @brief Is @tparam T fixed-size array (std::array), parsed from json array
+ * of exactly the same size
+ */
 template <typename T>
-struct is_dict_like<std::map<std::string, T>> : std::true_type {
+constexpr static bool is_fixed_array_v = is_fixed_array<T>::value;
+
+template <typename T, typename Enable = void>
+struct is_dict_like : std::false_type {};
+
+template <typename Key, typename T, typename Compare, typename Alloc>
+struct is_dict_like<std::map<Key, T, Compare, Alloc>,
+                    std::enable_if_t<is_key_string_v<Key>>> : std::true_type {
   template <typename... Args>
-  static inline void emplace(std::map<std::string, T> &m, Args &&...args) {
+  static inline void emplace(std::map<Key, T, Compare, Alloc> &m,
+                             Args &&...args) {
     m.emplace(std::forward<Args>(args)...);
   }
 };
 
-template <typename T>
-struct is_dict_like<std::unordered_map<std::string, T>> : std::true_type {
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Alloc>
+struct is_dict_like<std::unordered_map<Key, T, Hash, KeyEqual, Alloc>,
+                    std::enable_if_t<is_key_string_v<Key>>> : std::true_type {
   template <typename... Args>
-  static inline void emplace(std::unordered_map<std::string, T> &m,
-                             Args &&...args) {
+  static inline void
+  emplace(std::unordered_map<Key, T, Hash, KeyEqual, Alloc> &m,
+          Args &&...args) {
     m.emplace(std::forward<Args>(args)...);
   }
 };
 
 /**
  * @brief Is @tparam T dict like from some other type (std::map<std::string,
- * ...>, std::unordered_map<std::string, ...>)
+ * ...>, std::unordered_map<std::string, ...>, with any allocator)
  */
 template <typename T>
 constexpr static bool is_dict_like_v = is_dict_like<T>::value;
@@ -116,6 +174,28 @@ public:
 template <typename C, typename Ret, typename... Args>
 constexpr bool has_parse_v = has_parse<C, Ret, Args...>::value;
 
+template <typename C, typename Ret, typename... Args>
+class has_parse_into {
+  template <typename T>
+  static constexpr auto check(T *) -> typename std::is_same<
+      decltype(T::json_parse_into(std::declval<Args>()...)), Ret>::type;
+
+  template <typename>
+  static constexpr std::false_type check(...);
+
+  using type = decltype(check<C>(0));
+
+public:
+  static constexpr bool value = type::value;
+};
+
+/**
+ * @brief Does @tparam C has static method called `json_parse_into` with
+ * signature Ret(Args...)
+ */
+template <typename C, typename Ret, typename... Args>
+constexpr bool has_parse_into_v = has_parse_into<C, Ret, Args...>::value;
+
 template <typename C, typename Ret, typename... Args>
 class has_dump {
   template <typename T>
@@ -139,6 +219,130 @@ public:
 template <typename C, typename Ret, typename... Args>
 constexpr bool has_dump_v = has_dump<C, Ret, Args...>::value;
 
+/**
+ * @brief Default-construct @tparam T, using @ref resource if T is
+ * allocator-aware with polymorphic allocator (std::pmr containers and strings)
+ *
+ * @param resource memory resource for allocations of value
+ * @return default value
+ */
+template <typename T>
+inline T make_value(std::pmr::memory_resource *resource) {
+  if constexpr (std::uses_allocator_v<
+                    T, std::pmr::polymorphic_allocator<std::byte>>) {
+    return T(std::pmr::polymorphic_allocator<std::byte>(resource));
+  } else {
+    return T{};
+  }
+}
+
+template <typename Tokens, typename Enable = void>
+struct has_memory_resource : std::false_type {};
+
+template <typename Tokens>
+struct has_memory_resource<
+    Tokens,
+    std::void_t<decltype(std::declval<const Tokens &>().memory_resource())>>
+    : std::true_type {};
+
+template <typename Tokens, typename Enable = void>
+struct has_size_hint : std::false_type {};
+
+template <typename Tokens>
+struct has_size_hint<
+    Tokens, std::void_t<decltype(std::declval<const Tokens &>().size_hint())>>
+    : std::true_type {};
+
+/**
+ * @brief Check if container could reserve capacity (std::vector,
+ * std::unordered_set)
+ */
+template <typename T, typename Enable = void>
+struct has_reserve : std::false_type {};
+
+template <typename T>
+struct has_reserve<
+    T, std::void_t<decltype(std::declval<T &>().reserve(size_t{}))>>
+    : std::true_type {};
+
+/**
+ * @brief Check if token stream reads runs of numbers without producing
+ * tokens, @see IndexedTokenStream::read_numbers
+ */
+template <typename Tokens, typename Enable = void>
+struct has_read_numbers : std::false_type {};
+
+template <typename Tokens>
+struct has_read_numbers<
+    Tokens, std::void_t<decltype(std::declval<Tokens &>().read_numbers(
+                std::declval<bool (*)(double)>()))>> : std::true_type {};
+
+template <typename Tokens, typename Enable = void>
+struct has_offset : std::false_type {};
+
+template <typename Tokens>
+struct has_offset<
+    Tokens, std::void_t<decltype(std::declval<const Tokens &>().get_offset())>>
+    : std::true_type {};
+
+/**
+ * @brief Check if writer accepts pre-rendered key fragments,
+ * @see detail::KeyFragments
+ */
+template <typename Writer, typename Enable = void>
+struct has_raw_key : std::false_type {};
+
+template <typename Writer>
+struct has_raw_key<Writer,
+                   std::void_t<decltype(std::declval<Writer &>().raw_key(
+                       std::declval<std::string_view>()))>> : std::true_type {};
+
+/**
+ * @brief Memory resource of token stream
+ *
+ * @return tokens.memory_resource() if stream has one, default resource
+ * otherwise
+ */
+template <typename Tokens>
+inline std::pmr::memory_resource *memory_resource(const Tokens &tokens) {
+  if constexpr (has_memory_resource<Tokens>::value) {
+    return tokens.memory_resource();
+  } else {
+    return std::pmr::get_default_resource();
+  }
+}
+
+/**
+ * @brief Reserve capacity of array for elements of json array, if token
+ * stream could count them ahead
+ *
+ * @param target array, capacity is only grown
+ * @param tokens token stream, StartArray token was just retrieved
+ */
+template <typename T, typename Tokens>
+inline void reserve(T &target, const Tokens &tokens) {
+  if constexpr (has_reserve<T>::value && has_size_hint<Tokens>::value) {
+    const size_t size = tokens.size_hint();
+    if (size > 0) {
+      target.reserve(size);
+    }
+  }
+}
+
+/**
+ * @brief Offset in input of current token of token stream
+ *
+ * @return tokens.get_offset() if stream tracks offset, npos otherwise
+ */
+template <typename Tokens>
+inline size_t offset(const Tokens &tokens) {
+  if constexpr (has_offset<Tokens>::value) {
+    return tokens.get_offset();
+  } else {
+    return std::string::npos;
+  }
+}
+
 template <typename T>
 struct is_parse_result : std::false_type {};
 
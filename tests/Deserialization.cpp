@@ -1,23 +1,44 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <limits>
+#include <mutex>
+#include <memory_resource>
 #include <type_traits>
 
+#include <unistd.h>
+
 #include <rapidjson/error/en.h>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/reader.h>
 
 #include <ctjson/DeserializationHelper.hpp>
+#include <ctjson/DocumentStream.hpp>
+#include <ctjson/FusedDeserializer.hpp>
+#include <ctjson/IncrementalParser.hpp>
+#include <ctjson/IndexedTokenStream.hpp>
 #include <ctjson/Json.hpp>
+#include <ctjson/Parallel.hpp>
+#include <ctjson/TapeTokenStream.hpp>
 
 #include "Utils.hpp"
 
 using namespace ctjson;
 using namespace Catch::Matchers;
 
+template <typename T>
+ParseResult<T> parse_fused(
+    const std::string &json,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    rapidjson::StringStream ss(json.c_str());
+    return FusedDeserializer::parse<T>(ss, resource);
+}
+
 template <typename T>
 void expect_result(const std::string &json, const T &value) {
     auto result = parse<T>(json);
@@ -29,6 +50,22 @@ void expect_result(const std::string &json, const T &value) {
     }
 }
 
+template <typename... Args> std::string get_json_path(Args... args) {
+    const auto render = [](auto el) {
+        using T = std::decay_t<decltype(el)>;
+        if constexpr (std::is_same_v<T, const char *> ||
+                      std::is_same_v<T, std::string>) {
+            return "." + std::string(el);
+        } else if constexpr (std::is_integral_v<T>) {
+            return "[" + std::to_string(el) + "]";
+        } else {
+            static_assert(!sizeof(T), "Unexpected type");
+        }
+    };
+
+    return ("root" + ... + render(args));
+}
+
 TEST_CASE("Bool is deserialized", "[Deserialization]") {
     const auto test = [](const bool val) {
         expect_result<bool>(val ? "true" : "false", val);
@@ -79,6 +116,24 @@ TEST_CASE("String is deserialized", "[Deserialization]") {
     expect_result<std::string>("\"example\"", "example");
 }
 
+TEST_CASE("Strings are deserialized in-situ", "[Deserialization]") {
+    std::string json = "[\"plain\", \"esc\\\"aped\\n\"]";
+
+    auto result = parse_insitu<std::vector<std::string_view>>(json.data());
+    REQUIRE(result.is_ok());
+
+    const auto views = std::move(result).value();
+    REQUIRE(views == std::vector<std::string_view>{"plain", "esc\"aped\n"});
+    for (const auto view : views) {
+        REQUIRE(view.data() >= json.data());
+        REQUIRE(view.data() + view.size() <= json.data() + json.size());
+    }
+
+    std::string owned = "\"example\"";
+    expect_result<std::string>(owned, "example");
+    REQUIRE(parse_insitu<std::string>(owned.data()).value() == "example");
+}
+
 TEST_CASE("Optional is deserialized", "[Deserialization]") {
     expect_result<std::optional<std::string>>("\"example\"", "example");
     expect_result<std::optional<std::string>>("null", std::nullopt);
@@ -186,6 +241,11 @@ TEST_CASE("Object with `parse` method is deserialized", "[Deserialization]") {
         const auto object = ParseClass{.str = "meaning", .integer = 42};
 
         expect_result("{\"str\": \"meaning\", \"integer\": 42}", object);
+
+        std::string json = "{\"str\": \"mean\\u0069ng\", \"integer\": 42}";
+        auto result = parse_insitu<ParseClass>(json.data());
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() == object);
     }
     {
         auto result = parse<ParseClass>("{\"integer\": 42}");
@@ -243,6 +303,295 @@ TEST_CASE("Object with `Deserializable` instance is deserialized",
     }
 }
 
+struct NamedFieldsClass {
+    std::string str;
+    int integer;
+    std::optional<bool> oboolean;
+
+    constexpr static auto json_names =
+        field_names("str", "integer", "oboolean");
+
+    bool operator==(const NamedFieldsClass &other) const {
+        return str == other.str && integer == other.integer &&
+               oboolean == other.oboolean;
+    }
+
+    template <typename Tokens>
+    static ParseResult<NamedFieldsClass> json_parse(Tokens &tokens) {
+        NamedFieldsClass object;
+        auto result = DeserializationHelper::parse_object<json_names>(
+            tokens, object.str, object.integer, object.oboolean);
+        if (result.is_ok()) {
+            return ParseResult<NamedFieldsClass>::result(std::move(object));
+        } else {
+            return ParseResult<NamedFieldsClass>::convert_error(
+                std::move(result));
+        }
+    }
+};
+
+struct SkipUnknownClass {
+    std::string str;
+    std::vector<int> arr;
+
+    constexpr static auto json_names = field_names("str", "arr");
+
+    bool operator==(const SkipUnknownClass &other) const {
+        return str == other.str && arr == other.arr;
+    }
+
+    template <typename Tokens>
+    static ParseResult<SkipUnknownClass> json_parse(Tokens &tokens) {
+        SkipUnknownClass object;
+        auto result = DeserializationHelper::parse_object<
+            json_names, DeserializationHelper::UnknownKeys::Skip>(
+            tokens, object.str, object.arr);
+        if (result.is_ok()) {
+            return ParseResult<SkipUnknownClass>::result(std::move(object));
+        } else {
+            return ParseResult<SkipUnknownClass>::convert_error(
+                std::move(result));
+        }
+    }
+};
+
+struct SkipUnknownFieldsClass {
+    bool boolean;
+
+    bool operator==(const SkipUnknownFieldsClass &other) const {
+        return boolean == other.boolean;
+    }
+
+    template <typename Tokens>
+    static ParseResult<SkipUnknownFieldsClass> json_parse(Tokens &tokens) {
+        SkipUnknownFieldsClass object;
+        auto boolean = DeserializationHelper::Field("boolean", object.boolean);
+        auto result = DeserializationHelper::parse_object<
+            DeserializationHelper::UnknownKeys::Skip>(tokens, boolean);
+        if (result.is_ok()) {
+            return ParseResult<SkipUnknownFieldsClass>::result(
+                std::move(object));
+        } else {
+            return ParseResult<SkipUnknownFieldsClass>::convert_error(
+                std::move(result));
+        }
+    }
+};
+
+TEST_CASE("Unknown keys are skipped", "[Deserialization]") {
+    const std::string json = "{\
+        \"a\": [1, {\"x\": [2, \"y\"]}, [[]]], \
+        \"str\": \"s\", \
+        \"b\": {\"c\": \"d\", \"e\": {}}, \
+        \"c\": null, \
+        \"arr\": [1, 2], \
+        \"d\": \"tail\", \
+    }";
+
+    expect_result(json, SkipUnknownClass{.str = "s", .arr = {1, 2}});
+    expect_result(
+        "[{\"boolean\": true, \"other\": [{}]}, {\"boolean\": false}]",
+        std::vector<SkipUnknownFieldsClass>{{true}, {false}});
+
+    {
+        auto result = parse_fused<SkipUnknownClass>(json);
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() ==
+                SkipUnknownClass{.str = "s", .arr = {1, 2}});
+    }
+    {
+        auto result = parse<std::vector<SkipUnknownClass>>(
+            "[{\"u\": [1, 2], \"str\": \"a\", \"arr\": []}, \
+              {\"u\": {\"v\": []}, \"str\": \"b\", \"arr\": [1, true]}]");
+        REQUIRE(result.is_parse_error());
+        REQUIRE(std::move(result).error().path == get_json_path(1, "arr", 1));
+    }
+    {
+        auto result = parse<SkipUnknownClass>(
+            "{\"str\": \"a\", \"u\": [1, {\"v\" 2}], \"arr\": []}");
+        REQUIRE(result.is_json_error());
+    }
+    {
+        rapidjson::StringStream ss("[{\"a\": [1]}, 2, [3], 4]");
+        ContextTokenStream tokens(ss);
+        REQUIRE(tokens.next()->is_of_type<detail::Token::Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<detail::Token::Type::Uint>());
+        REQUIRE(tokens.get_path() == get_json_path(1));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<detail::Token::Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<detail::Token::Type::Uint>() == 4);
+        REQUIRE(tokens.get_path() == get_json_path(3));
+        REQUIRE(tokens.next()->is_of_type<detail::Token::Type::EndArray>());
+        REQUIRE(!tokens.skip_value());
+    }
+    {
+        using Type = detail::Token::Type;
+        // [[1, [2]], 3, [4], 5]
+        detail::ReplayTokenStream::Buffer buffer;
+        buffer.emplace_back(detail::Token::create<Type::StartArray>());
+        buffer.emplace_back(detail::Token::create<Type::StartArray>());
+        buffer.emplace_back(detail::Token::create<Type::Uint>(1u));
+        buffer.emplace_back(detail::Token::create<Type::StartArray>());
+        buffer.emplace_back(detail::Token::create<Type::Uint>(2u));
+        buffer.emplace_back(detail::Token::create<Type::EndArray>());
+        buffer.emplace_back(detail::Token::create<Type::EndArray>());
+        buffer.emplace_back(detail::Token::create<Type::Uint>(3u));
+        buffer.emplace_back(detail::Token::create<Type::StartArray>());
+        buffer.emplace_back(detail::Token::create<Type::Uint>(4u));
+        buffer.emplace_back(detail::Token::create<Type::EndArray>());
+        buffer.emplace_back(detail::Token::create<Type::Uint>(5u));
+        buffer.emplace_back(detail::Token::create<Type::EndArray>());
+        detail::ReplayTokenStream tokens(
+            buffer, [] { return std::string("root"); },
+            std::pmr::get_default_resource());
+        REQUIRE(tokens.next()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::Uint>());
+        REQUIRE(tokens.get_path() == get_json_path(1));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.get_path() == get_json_path(2));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Uint>() == 5);
+        REQUIRE(tokens.get_path() == get_json_path(3));
+        REQUIRE(!tokens.skip_value());
+        REQUIRE(tokens.next()->is_of_type<Type::EndArray>());
+        REQUIRE(!tokens.skip_value());
+        REQUIRE(tokens.is_complete());
+    }
+    {
+        IncrementalParser<std::vector<SkipUnknownClass>> parser;
+        REQUIRE(parser.feed("[{\"u\": [1, 2], \"str\": \"a\", \"arr\": []}, "
+                            "{\"u\": {\"v\": []}, \"str\": \"b\", "
+                            "\"arr\": [1, true]}]") == FeedStatus::Error);
+        auto result = parser.finish();
+        REQUIRE(result.is_parse_error());
+        REQUIRE(std::move(result).error().path == get_json_path(1, "arr", 1));
+    }
+}
+
+/**
+ * Token stream recording types of tokens seen by on_advance
+ */
+class AdvanceRecordingTokenStream
+    : public TokenStream<rapidjson::StringStream,
+                         AdvanceRecordingTokenStream> {
+    using Base =
+        TokenStream<rapidjson::StringStream, AdvanceRecordingTokenStream>;
+    friend Base;
+
+  public:
+    using Base::Base;
+
+    std::vector<detail::Token::Type> advanced;
+
+  private:
+    void on_advance(const token_type &token, size_t) {
+        advanced.push_back(token.type());
+    }
+
+    void on_skip(size_t) {}
+
+    void on_reset() { advanced.clear(); }
+};
+
+TEST_CASE("Tokens are read ahead", "[Deserialization]") {
+    using Type = detail::Token::Type;
+
+    const char *json = "{\"type\": \"b\", \"value\": [1, {\"c\": 2}], \"d\": 3";
+    {
+        rapidjson::StringStream ss(json);
+        LazyContextTokenStream tokens(ss);
+        REQUIRE(tokens.peek(3)->value<Type::Key>() == "value");
+        REQUIRE(tokens.peek(2)->value<Type::String>() == "b");
+        REQUIRE(!tokens.peek(decltype(tokens)::lookahead));
+        REQUIRE(tokens.get_path() == "root");
+        REQUIRE(tokens.next()->is_of_type<Type::StartObject>());
+        REQUIRE(tokens.next()->value<Type::Key>() == "type");
+        REQUIRE(tokens.get_path() == get_json_path("type"));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Key>() == "value");
+        REQUIRE(tokens.peek(4)->value<Type::Uint>() == 2);
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Key>() == "d");
+        REQUIRE(tokens.get_path() == get_json_path("d"));
+        REQUIRE(!tokens.peek(1));
+        REQUIRE(!tokens.has_error());
+        REQUIRE(tokens.next()->value<Type::Uint>() == 3);
+        REQUIRE(!tokens.next());
+        REQUIRE(tokens.has_error());
+        REQUIRE(tokens.get_path() == get_json_path("d"));
+    }
+    {
+        rapidjson::StringStream ss(json);
+        ContextTokenStream<rapidjson::StringStream, 1> tokens(ss);
+        REQUIRE(tokens.next()->is_of_type<Type::StartObject>());
+        REQUIRE(tokens.peek()->value<Type::Key>() == "type");
+        REQUIRE(!tokens.peek(1));
+        REQUIRE(tokens.next());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next());
+        REQUIRE(tokens.peek()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Key>() == "d");
+        REQUIRE(tokens.get_path() == get_json_path("d"));
+    }
+    {
+        // Skipped value ends with token of its outermost container
+        AdvanceRecordingTokenStream tokens(
+            rapidjson::StringStream("[{\"a\": [1]}, 2]"));
+        REQUIRE(tokens.next()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.peek()->is_of_type<Type::StartObject>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Uint>() == 2);
+        REQUIRE(tokens.advanced ==
+                std::vector<Type>{Type::StartArray, Type::StartObject,
+                                  Type::EndObject, Type::Uint});
+    }
+}
+
+TEST_CASE("Compile-time key index finds keys", "[Deserialization]") {
+    constexpr static auto names =
+        field_names("a", "b", "ab", "ba", "key", "other_key", "");
+    using Index = detail::KeyIndex<names>;
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        REQUIRE(Index::find(names[i]) == i);
+    }
+    REQUIRE(Index::find("c") == names.size());
+    REQUIRE(Index::find("aa") == names.size());
+    REQUIRE(Index::find("other_kez") == names.size());
+}
+
+TEST_CASE("Object with compile-time field names is deserialized",
+          "[Deserialization]") {
+    {
+        const auto object = NamedFieldsClass{
+            .str = "meaning", .integer = 42, .oboolean = std::nullopt};
+
+        expect_result("{\"str\": \"meaning\", \"integer\": 42}", object);
+        expect_result("{\"integer\": 42, \"str\": \"meaning\", "
+                      "\"oboolean\": null}",
+                      object);
+    }
+    {
+        auto result = parse<NamedFieldsClass>("{\"integer\": 42}");
+        REQUIRE(result.is_parse_error());
+    }
+    {
+        auto result = parse<NamedFieldsClass>(
+            "{\"str\": \"meaning\", \"integer\": 42, \"add\": 100}");
+        REQUIRE(result.is_parse_error());
+    }
+    {
+        auto result = parse<NamedFieldsClass>(
+            "{\"str\": \"meaning\", \"integer\": 42, \"integer\": 42}");
+        REQUIRE(result.is_parse_error());
+    }
+}
+
 struct FromStringClass {
     std::string str;
 
@@ -437,22 +786,6 @@ struct OuterClassError {
     }
 };
 
-template <typename... Args> std::string get_json_path(Args... args) {
-    const auto render = [](auto el) {
-        using T = std::decay_t<decltype(el)>;
-        if constexpr (std::is_same_v<T, const char *> ||
-                      std::is_same_v<T, std::string>) {
-            return "." + std::string(el);
-        } else if constexpr (std::is_integral_v<T>) {
-            return "[" + std::to_string(el) + "]";
-        } else {
-            static_assert(!sizeof(T), "Unexpected type");
-        }
-    };
-
-    return ("root" + ... + render(args));
-}
-
 TEST_CASE("Parsing errors are correct", "[Deserialization]") {
     const auto test = [](const char *json, const std::string &path) {
         auto result = parse<OuterClassError>(json);
@@ -589,4 +922,1044 @@ TEST_CASE("Json parsing errors are correct", "[Deserialization]") {
         \"number\": 1.0,\
         \"inners\": [{\"str\": \"example\" {} \"integer\": 42}, {}]\
     }");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Errors are recorded as codes", "[Deserialization]") {
+    const auto error_of = [](const std::string &json) {
+        auto result = parse<NamedFieldsClass>(json);
+        INFO("json is " << json);
+        REQUIRE(!result.is_ok());
+        auto error = std::move(result).error();
+        REQUIRE(error.offset != std::string::npos);
+        REQUIRE(error.offset <= json.size());
+        REQUIRE(error.path.has_value());
+        return error;
+    };
+
+    SECTION("Unexpected token") {
+        const auto error = error_of("[]");
+        REQUIRE(error.code == ErrorCode::UnexpectedToken);
+        REQUIRE(error.expected ==
+                detail::token_mask(detail::TokenType::StartObject));
+        REQUIRE(error.actual == detail::TokenType::StartArray);
+        REQUIRE(error.message() == "Expected start object, got start array");
+        REQUIRE(error.render() == error.message() + " at " + *error.path);
+    }
+
+    SECTION("Integer is out of range") {
+        const auto error = error_of(R"({"integer": 4294967296})");
+        REQUIRE(error.code == ErrorCode::OutOfRange);
+        REQUIRE(error.message() == "Integer value not in range");
+    }
+
+    SECTION("Keys are wrong") {
+        const auto duplicate = error_of(R"({"str": "a", "str": "b"})");
+        REQUIRE(duplicate.code == ErrorCode::DuplicateKey);
+        REQUIRE(duplicate.message() == "Duplicate key: str");
+
+        const auto unexpected = error_of(R"({"other": 1})");
+        REQUIRE(unexpected.code == ErrorCode::UnexpectedKey);
+        REQUIRE(unexpected.message() == "Unexpected key: other");
+        REQUIRE(unexpected.path == get_json_path("other"));
+
+        const auto missing = error_of(R"({"oboolean": true})");
+        REQUIRE(missing.code == ErrorCode::MissingKeys);
+        REQUIRE(missing.missing == 0b11);
+        REQUIRE(missing.message() ==
+                "Missing keys: str, integer, got end object");
+    }
+
+    SECTION("Keys of runtime fields are wrong") {
+        auto duplicate = parse<ParseClass>(R"({"str": "a", "str": "b"})");
+        REQUIRE(!duplicate.is_ok());
+        const auto duplicate_error = std::move(duplicate).error();
+        REQUIRE(duplicate_error.code == ErrorCode::DuplicateKey);
+        REQUIRE(duplicate_error.message() == "Duplicate key: str");
+        REQUIRE(duplicate_error.path == get_json_path("str"));
+
+        auto missing = parse<ParseClass>(R"({"integer": 1})");
+        REQUIRE(!missing.is_ok());
+        const auto missing_error = std::move(missing).error();
+        REQUIRE(missing_error.code == ErrorCode::MissingKeys);
+        REQUIRE(missing_error.message() ==
+                "Missing keys: str, got end object");
+    }
+
+    SECTION("Fixed-size array is too short") {
+        auto result = parse<std::array<int, 3>>("[1, 2]");
+        REQUIRE(result.is_parse_error());
+        const auto error = std::move(result).error();
+        REQUIRE(error.code == ErrorCode::ArraySize);
+        REQUIRE(error.elements.expected == 3);
+        REQUIRE(error.elements.actual == 2);
+        REQUIRE(error.message() == "Expected 3 elements, got 2");
+    }
+
+    SECTION("Json is invalid") {
+        const auto error = error_of(R"({"str" "a"})");
+        REQUIRE(error.code == ErrorCode::Json);
+        REQUIRE(error.message() ==
+                rapidjson::GetParseError_En(
+                    rapidjson::kParseErrorObjectMissColon));
+
+        auto fused = parse_fused<std::vector<int>>("[1, 2");
+        REQUIRE(fused.is_json_error());
+        REQUIRE(std::move(fused).error().offset == 5);
+    }
+
+    SECTION("Custom message is kept") {
+        auto error = ParseResult<int>::parse_error("custom").error();
+        REQUIRE(error.code == ErrorCode::Custom);
+        REQUIRE(error.message() == "custom");
+        REQUIRE(error.render() == "custom");
+    }
+}
+
+TEST_CASE("Scalars are converted from value tokens only",
+          "[Deserialization]") {
+    const auto message = [](auto result) {
+        REQUIRE(result.is_parse_error());
+        return std::move(result).error().message();
+    };
+
+    REQUIRE(parse<int>("-7").value() == -7);
+    REQUIRE(parse<double>("7").value() == 7.0);
+    REQUIRE(parse<uint64_t>("18446744073709551615").value() ==
+            std::numeric_limits<uint64_t>::max());
+    REQUIRE(parse<bool>("true").value());
+    REQUIRE(parse<std::string>("\"7\"").value() == "7");
+
+    REQUIRE(message(parse<int>("true")) == "Unexpected bool");
+    REQUIRE(message(parse<int>("1.5")) == "Unexpected double");
+    REQUIRE(message(parse<int>("\"1\"")) == "Unexpected string");
+    REQUIRE(message(parse<int>("null")) == "Unexpected null");
+    REQUIRE(message(parse<int>("4294967295")) == "Integer value not in range");
+    REQUIRE(message(parse<bool>("1")) == "Unexpected uint");
+    REQUIRE(message(parse<std::string>("{}")) == "Unexpected start object");
+    REQUIRE(message(parse<double>("[1]")) == "Unexpected start array");
+}
+
+TEST_CASE("Results are small and movable", "[Deserialization]") {
+    static_assert(sizeof(ParseResult<void>) == sizeof(void *));
+    static_assert(sizeof(ParseResult<int>) <= 2 * sizeof(void *));
+    static_assert(!std::is_copy_constructible_v<ParseResult<int>>);
+    static_assert(std::is_nothrow_move_assignable_v<ParseResult<int>>);
+    // Code, offset, text or names, mask, pointer to custom message and path
+    static_assert(sizeof(ParseResult<void>::Error) <=
+                  7 * sizeof(void *) + sizeof(std::optional<std::string>));
+
+    auto result = ParseResult<std::string>::result("value");
+    REQUIRE(result.is_ok());
+
+    result = ParseResult<std::string>::parse_error("error");
+    REQUIRE(result.is_parse_error());
+
+    auto converted = ParseResult<void>::convert_error(std::move(result));
+    REQUIRE(converted.is_parse_error());
+    REQUIRE(std::move(converted).error().message() == "error");
+
+    result = ParseResult<std::string>::result("other");
+    REQUIRE(std::move(result).value() == "other");
+
+    // Result stays failed after its error is taken
+    auto taken = parse<int>("\"x\"");
+    REQUIRE(taken.is_parse_error());
+    REQUIRE(std::move(taken).error().code == ErrorCode::UnexpectedToken);
+    REQUIRE(!taken.is_ok());
+    REQUIRE(std::move(taken).error().message() ==
+            "Error is taken from result");
+
+    // Result stays failed after it is moved from
+    auto moved = ParseResult<void>::parse_error("moved");
+    auto target = std::move(moved);
+    REQUIRE(target.is_parse_error());
+    REQUIRE(!moved.is_ok());
+    target = std::move(moved);
+    REQUIRE(!target.is_ok());
+    REQUIRE(!moved.is_ok());
+}
+
+using FusedMap = std::map<std::string, std::vector<InnerClass>>;
+
+template <>
+struct ctjson::FusedDeserializable<FusedMap> : public std::true_type {};
+
+TEST_CASE("Fused deserialization is correct", "[Deserialization]") {
+    {
+        using Type = std::vector<std::map<std::string, std::optional<int>>>;
+        auto result =
+            parse_fused<Type>("[{\"a\": 1, \"b\": null}, {}, {\"c\": -3,},]");
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() ==
+                Type{{{"a", 1}, {"b", std::nullopt}}, {}, {{"c", -3}}});
+    }
+    {
+        auto result = parse_fused<std::optional<std::set<std::string>>>(
+            "[\"x\", \"y\", \"x\"]");
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() ==
+                std::set<std::string>{"x", "y"});
+    }
+    {
+        const std::string json = "{\
+            \"boolean\": true, \
+            \"str\": \"example\", \
+            \"opt\": {\"str\": \"none\", \"oint\": null}, \
+            \"arr\": [{\"str\": \"one\", \"oint\": 1}], \
+            \"map\": {\"test\": {\"str\": \"two\", \"oint\": 2}}, \
+        }";
+
+        auto result = parse_fused<OuterClass>(json);
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() == parse<OuterClass>(json).value());
+    }
+
+    expect_result("{\"k\": [{\"str\": \"one\"}], \"l\": []}",
+                  FusedMap{
+                      {"k", {InnerClass{.str = "one", .oint = std::nullopt}}},
+                      {"l", {}}});
+}
+
+TEST_CASE("Fused deserialization errors match Deserializer",
+          "[Deserialization]") {
+    using Type = std::map<std::string, std::vector<InnerClassError>>;
+
+    const auto test = [](const char *json) {
+        INFO("json is " << json);
+        auto fused = parse_fused<Type>(json);
+        auto pull = parse<Type>(json);
+        REQUIRE(!fused.is_ok());
+        const bool is_json_error = pull.is_json_error();
+        REQUIRE(fused.is_json_error() == is_json_error);
+        auto fused_error = std::move(fused).error();
+        auto pull_error = std::move(pull).error();
+        REQUIRE(fused_error.path.has_value());
+        if (!is_json_error) {
+            REQUIRE(fused_error.message() == pull_error.message());
+            REQUIRE(fused_error.path == pull_error.path);
+        }
+    };
+
+    test("[]");
+    test("{\"a\": {}}");
+    test("{\"a\": [true]}");
+    test("{\"a\": [{\"str\": \"x\", \"integer\": 1}, {\"str\": []}]}");
+    test("{\"a\": [], \"b\": [{\"str\": \"x\", \"integer\": 1.5}]}");
+    test("{\"a\": [{\"str\": \"x\", \"integer\": 1}, 42]}");
+    test("{\"a\": [{\"str\": \"x\", \"integer\": 1,}, {\"str\"]}");
+    test("{\"a\": [}");
+}
+
+TEST_CASE("Lazy path matches eager path", "[Deserialization]") {
+    const char *json = "{\"a\": [1, {\"b\\u0063\": [[], {\"\": 2}]}], \
+                         \"d\" : {\"e\" :3}, \"f\": [4, 5]}";
+
+    rapidjson::StringStream eager_ss(json);
+    ContextTokenStream eager(eager_ss);
+    rapidjson::StringStream lazy_ss(json);
+    LazyContextTokenStream lazy(lazy_ss);
+
+    std::string insitu_json = json;
+    rapidjson::InsituStringStream insitu_ss(insitu_json.data());
+    LazyContextTokenStream insitu(insitu_ss);
+
+    while (eager.next()) {
+        REQUIRE(lazy.next());
+        REQUIRE(insitu.next());
+        INFO("path is " << eager.get_path().value());
+        REQUIRE(lazy.get_path() == eager.get_path());
+        REQUIRE(insitu.get_path() == eager.get_path());
+    }
+    REQUIRE(!lazy.next());
+    REQUIRE(eager.get_path() == "root");
+
+    {
+        rapidjson::StringStream ss(json);
+        LazyContextTokenStream tokens(ss);
+        REQUIRE(tokens.next());
+        REQUIRE(tokens.next());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next());
+        REQUIRE(tokens.get_path() == get_json_path("d"));
+    }
+}
+
+TEST_CASE("Values are deserialized to memory resource", "[Deserialization]") {
+    using Strings = std::pmr::vector<std::pmr::string>;
+    using Dict = std::pmr::map<std::pmr::string, Strings>;
+    using Type = std::pmr::vector<Dict>;
+
+    const std::string json = "[{\"long key to not fit in small string\": \
+        [\"long value to not fit in small string\", \"b\"]}, {}]";
+    const Type expected = {
+        {{"long key to not fit in small string",
+          {"long value to not fit in small string", "b"}}},
+        {}};
+
+    std::pmr::monotonic_buffer_resource arena;
+    // Any allocation outside of arena fails
+    auto *previous =
+        std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    auto pull = parse<Type>(json, &arena);
+    auto fused = parse_fused<Type>(json, &arena);
+    auto optional = parse<std::optional<Strings>>("[\"x\"]", &arena);
+
+    std::pmr::set_default_resource(previous);
+
+    REQUIRE(pull.is_ok());
+    REQUIRE(fused.is_ok());
+    REQUIRE(optional.is_ok());
+
+    const auto value = std::move(pull).value();
+    REQUIRE(value == expected);
+    REQUIRE(value.get_allocator().resource() == &arena);
+    REQUIRE(value[0].begin()->first.get_allocator().resource() == &arena);
+    REQUIRE(value[0].begin()->second[0].get_allocator().resource() == &arena);
+    REQUIRE(std::move(fused).value() == expected);
+    REQUIRE(std::move(optional).value()->get_allocator().resource() ==
+            &arena);
+}
+
+struct ParseIntoClass {
+    std::string str;
+    std::vector<std::string> strs;
+    std::optional<std::map<std::string, std::vector<int>>> map;
+    std::set<std::string> set;
+
+    constexpr static auto json_names = field_names("str", "strs", "map", "set");
+
+    bool operator==(const ParseIntoClass &other) const {
+        return str == other.str && strs == other.strs && map == other.map &&
+               set == other.set;
+    }
+
+    template <typename Tokens>
+    static ParseResult<void> json_parse_into(ParseIntoClass &object,
+                                             Tokens &tokens) {
+        return DeserializationHelper::parse_object<json_names>(
+            tokens, object.str, object.strs, object.map, object.set);
+    }
+};
+
+TEST_CASE("Values are parsed into existing objects", "[Deserialization]") {
+    const std::string long_str = "long string to not fit in small string";
+    const std::string json = "{\"str\": \"" + long_str + "\", \
+        \"strs\": [\"" + long_str + "\", \"b\", \"c\"], \
+        \"map\": {\"a\": [1, 2, 3], \"b\": []}, \
+        \"set\": [\"x\", \"y\"]}";
+
+    std::vector<ParseIntoClass> objects;
+    REQUIRE(parse_into(objects, "[" + json + "]").is_ok());
+    REQUIRE(objects == parse<std::vector<ParseIntoClass>>("[" + json + "]")
+                           .value());
+
+    const auto *object = objects.data();
+    const auto *str = object->str.data();
+    const auto *strs = object->strs.data();
+    const auto *strs_str = object->strs[0].data();
+    const auto *map_value = &object->map->at("a");
+    const auto *map_value_data = map_value->data();
+
+    REQUIRE(parse_into(objects, "[" + json + "]").is_ok());
+    REQUIRE(objects.data() == object);
+    REQUIRE(object->str.data() == str);
+    REQUIRE(object->strs.data() == strs);
+    REQUIRE(object->strs[0].data() == strs_str);
+    REQUIRE(&object->map->at("a") == map_value);
+    REQUIRE(object->map->at("a").data() == map_value_data);
+
+    REQUIRE(parse_into(objects, "[{\"str\": \"s\", \"strs\": [\"d\"], \
+                                   \"set\": [\"z\", \"x\"]}, " +
+                                    json + "]")
+                .is_ok());
+    REQUIRE(objects.size() == 2);
+    REQUIRE(objects.data() != object);
+    REQUIRE(objects[0] == ParseIntoClass{.str = "s",
+                                         .strs = {"d"},
+                                         .map = std::nullopt,
+                                         .set = {"x", "z"}});
+    REQUIRE(objects[1] == parse<ParseIntoClass>(json).value());
+
+    REQUIRE(parse_into(objects, "[]").is_ok());
+    REQUIRE(objects.empty());
+
+    {
+        std::vector<bool> bools = {true};
+        REQUIRE(parse_into(bools, "[false, true]").is_ok());
+        REQUIRE(bools == std::vector<bool>{false, true});
+    }
+    {
+        std::optional<int> integer = 1;
+        REQUIRE(parse_into(integer, "true").is_parse_error());
+        REQUIRE(parse_into(integer, "null").is_ok());
+        REQUIRE(integer == std::nullopt);
+    }
+    {
+        ParseIntoClass value;
+        auto result = parse_into(value, "{\"str\": \"s\", \"strs\": [1]}");
+        REQUIRE(result.is_parse_error());
+        REQUIRE(std::move(result).error().path == get_json_path("strs", 0));
+    }
+}
+
+TEST_CASE("Json is parsed from file", "[Deserialization]") {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("ctjson_parse_file_" + std::to_string(::getpid()));
+    const auto write = [&path](const std::string &content) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content;
+    };
+
+    write("{\"str\": \"example\", \"oint\": 42}");
+    {
+        auto result = parse_file<InnerClass>(path);
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() ==
+                InnerClass{.str = "example", .oint = 42});
+    }
+
+    // No terminating null after content
+    write("[{\"str\": \"a\"}, {\"str\": 1}]");
+    {
+        auto result = parse_file<std::vector<InnerClass>>(path);
+        REQUIRE(result.is_parse_error());
+        REQUIRE(std::move(result).error().path == get_json_path(1, "str"));
+    }
+
+    write("");
+    REQUIRE(parse_file<InnerClass>(path).is_json_error());
+
+    std::filesystem::remove(path);
+    {
+        auto result = parse_file<InnerClass>(path);
+        REQUIRE(result.is_io_error());
+        REQUIRE(!std::move(result).error().path.has_value());
+    }
+}
+
+TEST_CASE("Multiple documents are read from one stream", "[Deserialization]") {
+    SECTION("Newline-delimited json") {
+        const std::string json = "{\"str\": \"a\", \"oint\": 1}\n"
+                                 "\n"
+                                 "{\"str\": \"b\", \"oint\": }\n"
+                                 "{\"str\": 2}\n"
+                                 "  {\"str\": \"c\"}  \n";
+        DocumentStream<InnerClass, rapidjson::StringStream> documents(
+            rapidjson::StringStream(json.c_str()));
+
+        auto first = documents.next();
+        REQUIRE(first.has_value());
+        REQUIRE(first->is_ok());
+        REQUIRE(std::move(*first).value() ==
+                InnerClass{.str = "a", .oint = 1});
+
+        auto second = documents.next();
+        REQUIRE(second.has_value());
+        REQUIRE(second->is_json_error());
+
+        auto third = documents.next();
+        REQUIRE(third.has_value());
+        REQUIRE(third->is_parse_error());
+        REQUIRE(std::move(*third).error().path == get_json_path("str"));
+
+        auto fourth = documents.next();
+        REQUIRE(fourth.has_value());
+        REQUIRE(fourth->is_ok());
+        REQUIRE(std::move(*fourth).value() ==
+                InnerClass{.str = "c", .oint = std::nullopt});
+
+        REQUIRE(!documents.next().has_value());
+    }
+
+    SECTION("Concatenated json") {
+        const std::string json = "[1][2, 3] [] 4";
+        DocumentStream<std::vector<int>, rapidjson::StringStream> documents(
+            rapidjson::StringStream(json.c_str()));
+
+        for (const auto &expected : std::vector<std::vector<int>>{
+                 {1}, {2, 3}, {}}) {
+            auto result = documents.next();
+            REQUIRE(result.has_value());
+            REQUIRE(result->is_ok());
+            REQUIRE(std::move(*result).value() == expected);
+        }
+
+        auto result = documents.next();
+        REQUIRE(result.has_value());
+        REQUIRE(result->is_parse_error());
+        REQUIRE(!documents.next().has_value());
+    }
+
+    SECTION("Empty input") {
+        DocumentStream<int, rapidjson::StringStream> documents(
+            rapidjson::StringStream(" \n\t"));
+        REQUIRE(!documents.next().has_value());
+    }
+}
+
+TEST_CASE("Newline-delimited json is parsed in parallel", "[Deserialization]") {
+    std::string json;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 100 == 42) {
+            json += "[\"error\"]\n";
+        } else {
+            json += "[" + std::to_string(i) + "]\n";
+        }
+    }
+    json += "[1000]";
+
+    SECTION("Results are in input order") {
+        for (const size_t chunk_size : {size_t{1}, size_t{100}, json.size()}) {
+            const auto results =
+                parse_ndjson_parallel<std::vector<int>>(json, 4, chunk_size);
+            REQUIRE(results.size() == 1001);
+            for (int i = 0; i <= 1000; ++i) {
+                const auto &result = results[i];
+                if (i % 100 == 42) {
+                    REQUIRE(result.is_parse_error());
+                } else {
+                    REQUIRE(result.is_ok());
+                }
+            }
+        }
+
+        auto results = parse_ndjson_parallel<std::vector<int>>(json, 3, 64);
+        REQUIRE(std::move(results[7]).value() == std::vector<int>{7});
+        REQUIRE(std::move(results[1000]).value() == std::vector<int>{1000});
+    }
+
+    SECTION("Results are passed to callback") {
+        std::mutex mutex;
+        int sum = 0;
+        size_t errors = 0;
+        parse_ndjson_parallel_unordered<std::vector<int>>(
+            json,
+            [&](ParseResult<std::vector<int>> &&result) {
+                const std::lock_guard lock(mutex);
+                if (result.is_ok()) {
+                    sum += std::move(result).value().at(0);
+                } else {
+                    ++errors;
+                }
+            },
+            4, 128);
+
+        REQUIRE(errors == 10);
+        REQUIRE(sum == 1000 * 1001 / 2 - (42 + 142 + 242 + 342 + 442 + 542 +
+                                           642 + 742 + 842 + 942));
+    }
+
+    SECTION("Empty input") {
+        REQUIRE(parse_ndjson_parallel<int>("").empty());
+        REQUIRE(parse_ndjson_parallel<int>("\n\n").empty());
+    }
+}
+
+TEST_CASE("Structural index is built", "[Deserialization]") {
+    // Index built one byte at a time
+    const auto expected_index = [](const std::string &json) {
+        std::vector<uint32_t> index;
+        bool in_string = false;
+        bool in_scalar = false;
+        for (size_t i = 0; i < json.size(); ++i) {
+            const char c = json[i];
+            if (in_string) {
+                if (c == '\\') {
+                    ++i;
+                } else if (c == '"') {
+                    in_string = false;
+                }
+                continue;
+            }
+            const bool is_op = std::string_view("{}[]:,").find(c) !=
+                               std::string_view::npos;
+            const bool is_space = std::string_view(" \t\n\r").find(c) !=
+                                  std::string_view::npos;
+            if (is_op || c == '"' || (!is_space && !in_scalar)) {
+                index.push_back(i);
+            }
+            in_string = c == '"';
+            in_scalar = !is_op && !is_space && c != '"';
+        }
+
+        return index;
+    };
+
+    const auto test = [&](const std::string &json) {
+        INFO("json is " << json);
+        std::vector<uint32_t> index;
+        REQUIRE(detail::build_structural_index(json, index));
+        REQUIRE(index == expected_index(json));
+    };
+
+    test("");
+    test("{\"a\": [1, 2.5e3, true], \"b\\\"\": null,}");
+    // Escapes and strings crossing block boundaries
+    for (size_t shift = 0; shift < 70; ++shift) {
+        test(std::string(shift, ' ') + "[\"x\\\\\", \"" +
+             std::string(shift, '\\') + std::string(shift % 2, '\\') +
+             "\\\"\", -12, \"\\\\\\\"\",{\"k\":false}]");
+    }
+
+    std::vector<uint32_t> index;
+    REQUIRE(!detail::build_structural_index("[\"abc", index));
+    REQUIRE(!detail::build_structural_index("[\"abc\\\"]", index));
+
+    std::string block(64, ' ');
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = "\\\"{}[]:, \t\n\rx"[i % 14];
+    }
+    const auto scalar = detail::classify_block_scalar(block.data());
+    const auto same_masks = [&scalar](const detail::BlockMasks &masks) {
+        return masks.backslash == scalar.backslash &&
+               masks.quote == scalar.quote && masks.op == scalar.op &&
+               masks.whitespace == scalar.whitespace;
+    };
+    REQUIRE(same_masks(detail::classify_block(block.data())));
+#if defined(__SSE2__)
+    REQUIRE(same_masks(detail::classify_block_sse2(block.data())));
+#endif
+}
+
+template <typename Lhs, typename Rhs>
+bool same_token_value(const Lhs &lhs, const Rhs &rhs) {
+    using Type = detail::Token::Type;
+    if (lhs.template is_of_type<Type::Key>()) {
+        return lhs.template value<Type::Key>() ==
+               rhs.template value<Type::Key>();
+    } else if (lhs.template is_of_type<Type::String>()) {
+        return lhs.template value<Type::String>() ==
+               rhs.template value<Type::String>();
+    } else if (lhs.template is_of_type<Type::Int>()) {
+        return lhs.template value<Type::Int>() ==
+               rhs.template value<Type::Int>();
+    } else if (lhs.template is_of_type<Type::Uint>()) {
+        return lhs.template value<Type::Uint>() ==
+               rhs.template value<Type::Uint>();
+    } else if (lhs.template is_of_type<Type::Int64>()) {
+        return lhs.template value<Type::Int64>() ==
+               rhs.template value<Type::Int64>();
+    } else if (lhs.template is_of_type<Type::Uint64>()) {
+        return lhs.template value<Type::Uint64>() ==
+               rhs.template value<Type::Uint64>();
+    } else if (lhs.template is_of_type<Type::Double>()) {
+        return lhs.template value<Type::Double>() ==
+               rhs.template value<Type::Double>();
+    } else if (lhs.template is_of_type<Type::Bool>()) {
+        return lhs.template value<Type::Bool>() ==
+               rhs.template value<Type::Bool>();
+    } else if (lhs.template is_of_type<Type::EndObject>()) {
+        return lhs.template value<Type::EndObject>() ==
+               rhs.template value<Type::EndObject>();
+    } else if (lhs.template is_of_type<Type::EndArray>()) {
+        return lhs.template value<Type::EndArray>() ==
+               rhs.template value<Type::EndArray>();
+    }
+
+    return true;
+}
+
+TEST_CASE("Indexed token stream matches rapidjson reader",
+          "[Deserialization]") {
+    using Type = detail::Token::Type;
+
+    const auto test = [&](const char *json) {
+        INFO("json is " << json);
+        rapidjson::StringStream ss(json);
+        LazyContextTokenStream lazy(ss);
+        IndexedTokenStream indexed(json);
+
+        while (const auto expected = lazy.next()) {
+            const auto token = indexed.next();
+            REQUIRE(token);
+            REQUIRE(token->name() == expected->name());
+            REQUIRE(same_token_value(*token, *expected));
+            REQUIRE(indexed.get_path() == lazy.get_path());
+        }
+        REQUIRE(!indexed.next());
+        REQUIRE(indexed.has_error() == lazy.has_error());
+        if (lazy.has_error()) {
+            REQUIRE(indexed.get_error() == lazy.get_error());
+            REQUIRE(indexed.get_path() == lazy.get_path());
+        } else {
+            REQUIRE(indexed.is_complete());
+        }
+    };
+
+    test("{\"a\": [1, -1, 0, -0, 4294967295, 4294967296, -2147483648, "
+         "-2147483649, 18446744073709551615, 18446744073709551616, "
+         "-9223372036854775808, -9223372036854775809, 1.5, -2.5e-3, 1E2]}");
+    test("[12345678, 1234567812345678, 9223372036854775807, "
+         "-9223372036854775807, 123456781234567812345678, "
+         "0.12345678123456781, 12345678.87654321e+12, 1234567890x]");
+    test("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\", \"\\u0041\\u00e9\\u20AC\", "
+         "\"\\ud83d\\ude00\", \"plain\", \"\"]");
+    test("{\"k\\u0065y\": {\"\": [[], {}, [true, false, null]]}, \"x\": 1,}");
+    test("[1, 2,]");
+    test(" 42 ");
+    test("");
+    test("   ");
+    test("[");
+    test("[1");
+    test("[1 2]");
+    test("[1x]");
+    test("[truex]");
+    test("[tru]");
+    test("[01]");
+    test("[-]");
+    test("[1.]");
+    test("[1e]");
+    test("[,]");
+    test("[1,,2]");
+    test("{,}");
+    test("{\"a\"}");
+    test("{\"a\" 1}");
+    test("{\"a\": 1 \"b\": 2}");
+    test("{\"a\": }");
+    test("{1: 2}");
+    test("{\"a\": [1, {\"b\": \"c]}");
+    test("[\"\\x\"]");
+    test("[\"\\u12g4\"]");
+    test("[\"\\ud83d\"]");
+    test("[\"a\tb\"]");
+
+    {
+        IndexedTokenStream tokens("[1e400]");
+        REQUIRE(tokens.next());
+        REQUIRE(!tokens.next());
+        REQUIRE(tokens.get_error() ==
+                rapidjson::GetParseError_En(
+                    rapidjson::kParseErrorNumberTooBig));
+    }
+
+    SECTION("Values are skipped") {
+        const char *json = "[{\"a\": [1, \"\\\"]\"]}, 2, [3], 4]";
+        IndexedTokenStream tokens(json);
+        REQUIRE(tokens.next()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::Uint>());
+        REQUIRE(tokens.get_path() == get_json_path(1));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Uint>() == 4);
+        REQUIRE(tokens.get_path() == get_json_path(3));
+        REQUIRE(!tokens.skip_value());
+        REQUIRE(tokens.next()->is_of_type<Type::EndArray>());
+        REQUIRE(!tokens.skip_value());
+        REQUIRE(tokens.is_complete());
+
+        IndexedTokenStream invalid("[[1, {\"v\" 2}], 3]");
+        REQUIRE(invalid.next());
+        REQUIRE(!invalid.skip_value());
+        REQUIRE(invalid.has_error());
+    }
+
+    SECTION("Input is not null-terminated") {
+        const std::string json = "[12345]";
+        auto result = parse_indexed<std::vector<int>>(
+            std::string_view(json.data(), 4));
+        REQUIRE(result.is_json_error());
+        REQUIRE(parse_indexed<std::vector<int>>(json).value() ==
+                std::vector<int>{12345});
+    }
+}
+
+TEST_CASE("Tape token stream matches rapidjson reader", "[Deserialization]") {
+    using Type = detail::Token::Type;
+
+    const auto test = [](const char *json) {
+        INFO("json is " << json);
+        rapidjson::StringStream lazy_ss(json);
+        LazyContextTokenStream lazy(lazy_ss);
+        TapeTokenStream tape(rapidjson::StringStream{json});
+
+        while (const auto expected = lazy.next()) {
+            const auto token = tape.next();
+            REQUIRE(token);
+            REQUIRE(token->name() == expected->name());
+            REQUIRE(same_token_value(*token, *expected));
+            REQUIRE(tape.get_path() == lazy.get_path());
+        }
+        REQUIRE(!tape.next());
+        REQUIRE(tape.has_error() == lazy.has_error());
+        if (lazy.has_error()) {
+            REQUIRE(tape.get_error() == lazy.get_error());
+            REQUIRE(tape.get_path() == lazy.get_path());
+        } else {
+            REQUIRE(tape.is_complete());
+        }
+    };
+
+    test("{\"a\": [1, -1, 4294967296, -2147483649, 1.5, true, null], "
+         "\"b\\u0063\": {\"\": \"x\\ny\"}, \"d\": [[], {}],}");
+    test("");
+    test("[1, 2");
+    test("{\"a\": [1, {\"b\" 2}]}");
+
+    SECTION("Values are skipped") {
+        TapeTokenStream tokens(
+            rapidjson::StringStream("[{\"a\": [1, \"x\"]}, 2, [3], 4]"));
+        REQUIRE(tokens.tape().type(0) == Type::StartArray);
+        REQUIRE(tokens.next()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::Uint>());
+        REQUIRE(tokens.get_path() == get_json_path(1));
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.peek()->is_of_type<Type::StartArray>());
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.next()->value<Type::Uint>() == 4);
+        REQUIRE(tokens.get_path() == get_json_path(3));
+        REQUIRE(!tokens.skip_value());
+        REQUIRE(tokens.next()->is_of_type<Type::EndArray>());
+        REQUIRE(tokens.is_complete());
+
+        TapeTokenStream invalid(rapidjson::StringStream("[[1, {\"v\" 2}], 3]"));
+        REQUIRE(invalid.next());
+        REQUIRE(!invalid.skip_value());
+        REQUIRE(invalid.has_error());
+    }
+
+    SECTION("Deeply nested values are tokenized") {
+        constexpr size_t depth = 100000;
+        const std::string json =
+            std::string(depth, '[') + std::string(depth, ']');
+        TapeTokenStream tokens(rapidjson::StringStream(json.c_str()));
+        REQUIRE(tokens.tape().type(0) == Type::StartArray);
+        REQUIRE(tokens.skip_value());
+        REQUIRE(tokens.is_complete());
+    }
+
+    SECTION("Values are deserialized") {
+        const char *json =
+            "[{\"str\": \"a\", \"oint\": 1}, {\"str\": \"b\\\"\"}]";
+        TapeTokenStream tokens(rapidjson::StringStream{json});
+        auto result = Deserializer::parse<std::vector<InnerClass>>(tokens);
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value() ==
+                std::vector<InnerClass>{
+                    {.str = "a", .oint = 1},
+                    {.str = "b\"", .oint = std::nullopt}});
+
+        TapeTokenStream invalid(
+            rapidjson::StringStream("[{\"str\": \"a\"}, {\"str\": 1}]"));
+        auto error = Deserializer::parse<std::vector<InnerClass>>(invalid);
+        REQUIRE(error.is_parse_error());
+        REQUIRE(std::move(error).error().path == get_json_path(1, "str"));
+    }
+}
+
+TEST_CASE("Arrays are reserved from size hint", "[Deserialization]") {
+    const std::string json = R"([1, "a,]", [2, 3], {"k": [4]}, null,])";
+
+    SECTION("Elements are counted ahead") {
+        IndexedTokenStream indexed(json);
+        REQUIRE(indexed.size_hint() == 0);
+        REQUIRE(indexed.next());
+        REQUIRE(indexed.size_hint() == 5);
+        REQUIRE(indexed.next());
+        REQUIRE(indexed.size_hint() == 0);
+
+        TapeTokenStream tape(rapidjson::StringStream(json.c_str()));
+        REQUIRE(tape.next());
+        REQUIRE(tape.size_hint() == 5);
+        REQUIRE(tape.next());
+        REQUIRE(tape.size_hint() == 0);
+    }
+
+    SECTION("Capacity is reserved") {
+        const std::string numbers = "[1, 2, 3, 4, 5]";
+
+        auto indexed = parse_indexed<std::vector<int>>(numbers);
+        REQUIRE(indexed.is_ok());
+        REQUIRE(std::move(indexed).value().capacity() == 5);
+
+        TapeTokenStream tape(rapidjson::StringStream(numbers.c_str()));
+        auto result = Deserializer::parse<std::vector<int>>(tape);
+        REQUIRE(result.is_ok());
+        REQUIRE(std::move(result).value().capacity() == 5);
+
+        std::vector<std::vector<int>> nested;
+        TapeTokenStream nested_tape(
+            rapidjson::StringStream("[[1, 2, 3], [4], []]"));
+        REQUIRE(Deserializer::parse_into(nested, nested_tape).is_ok());
+        REQUIRE(nested.capacity() == 3);
+        REQUIRE(nested[0].capacity() == 3);
+        REQUIRE(nested[1].capacity() == 1);
+    }
+}
+
+template <typename T> void expect_same_parse(const std::string &json) {
+    INFO("json is " << json);
+
+    rapidjson::StringStream ss(json.c_str());
+    LazyContextTokenStream lazy(ss);
+    auto expected = Deserializer::parse<T>(lazy);
+    IndexedTokenStream indexed(json);
+    auto result = Deserializer::parse<T>(indexed);
+    TapeTokenStream tape(rapidjson::StringStream(json.c_str()));
+    auto tape_result = Deserializer::parse<T>(tape);
+
+    REQUIRE(result.is_ok() == expected.is_ok());
+    REQUIRE(tape_result.is_ok() == expected.is_ok());
+    if (expected.is_ok()) {
+        const auto value = std::move(expected).value();
+        REQUIRE(std::move(result).value() == value);
+        REQUIRE(std::move(tape_result).value() == value);
+    } else {
+        const auto error = std::move(expected).error().render();
+        REQUIRE(std::move(result).error().render() == error);
+        REQUIRE(std::move(tape_result).error().render() == error);
+    }
+}
+
+TEST_CASE("Numeric arrays are read in bulk", "[Deserialization]") {
+    using Type = detail::Token::Type;
+
+    SECTION("Numbers are read without tokens") {
+        const std::string json = "[1, -2, 3.5, 4294967296, 5]";
+        std::vector<double> values;
+        const auto sink = [&values](const auto number) {
+            if (number > 10) {
+                return false;
+            }
+            values.push_back(static_cast<double>(number));
+            return true;
+        };
+
+        IndexedTokenStream indexed(json);
+        REQUIRE(indexed.next());
+        REQUIRE(indexed.read_numbers(sink) == 3);
+        REQUIRE(values == std::vector<double>{1, -2, 3.5});
+        REQUIRE(indexed.get_path() == get_json_path(2));
+        REQUIRE(indexed.next()->value<Type::Uint64>() == 4294967296);
+        REQUIRE(indexed.read_numbers(sink) == 1);
+        REQUIRE(indexed.get_path() == get_json_path(4));
+        REQUIRE(indexed.read_numbers(sink) == 0);
+        REQUIRE(indexed.next()->is_of_type<Type::EndArray>());
+        REQUIRE(indexed.is_complete());
+
+        values.clear();
+        TapeTokenStream tape(rapidjson::StringStream(json.c_str()));
+        REQUIRE(tape.next());
+        REQUIRE(tape.read_numbers(sink) == 3);
+        REQUIRE(values == std::vector<double>{1, -2, 3.5});
+        REQUIRE(tape.get_path() == get_json_path(2));
+        REQUIRE(tape.next()->value<Type::Uint64>() == 4294967296);
+        REQUIRE(tape.read_numbers(sink) == 1);
+        REQUIRE(tape.next()->is_of_type<Type::EndArray>());
+        REQUIRE(tape.is_complete());
+    }
+
+    SECTION("Results match token by token parsing") {
+        using Doubles = std::vector<double>;
+        using Ints = std::vector<int32_t>;
+        using Bytes = std::vector<uint8_t>;
+        using Triple = std::array<float, 3>;
+
+        expect_same_parse<Doubles>("[1, -2.5, 1e3, 18446744073709551616]");
+        expect_same_parse<std::vector<Doubles>>("[[1, 2], [], [3,],]");
+        expect_same_parse<Ints>("[1, -2, 2147483647, -2147483648]");
+        expect_same_parse<Ints>("[1, 2, 2147483648]");
+        expect_same_parse<Ints>("[1, 2, 3.5]");
+        expect_same_parse<Ints>("[1, 2, \"3\"]");
+        expect_same_parse<Ints>("[1, 2 3]");
+        expect_same_parse<Ints>("[1, 2x]");
+        expect_same_parse<Ints>("[1, 2");
+        expect_same_parse<Bytes>("[255, 0, 256]");
+        expect_same_parse<Triple>("[1, 2.5, 3]");
+        expect_same_parse<Triple>("[1, 2]");
+        expect_same_parse<Triple>("[1, 2, 3, 4]");
+        expect_same_parse<Triple>("[1, 2, null]");
+    }
+
+    SECTION("Arrays are parsed into") {
+        std::vector<float> values(5, 7.0f);
+        IndexedTokenStream tokens("[1, 2, 3]");
+        REQUIRE(Deserializer::parse_into(values, tokens).is_ok());
+        REQUIRE(values == std::vector<float>{1, 2, 3});
+
+        std::array<int, 2> pair = {7, 7};
+        IndexedTokenStream invalid("[1, 2, 3]");
+        auto result = Deserializer::parse_into(pair, invalid);
+        REQUIRE(!result.is_ok());
+        REQUIRE(std::move(result).error().render() ==
+                "Expected end array, got uint at " + get_json_path(2));
+        REQUIRE(pair == std::array<int, 2>{1, 2});
+    }
+}
+
+TEST_CASE("Json is parsed incrementally", "[Deserialization]") {
+    using Type = std::map<std::string, std::vector<InnerClass>>;
+
+    // Parse json fed in parts of given size
+    const auto parse_parts = [](const std::string &json, const size_t size) {
+        IncrementalParser<Type> parser;
+        for (size_t i = 0; i < json.size(); i += size) {
+            const auto part = std::string_view(json).substr(i, size);
+            if (parser.feed(part) != FeedStatus::NeedMoreInput) {
+                break;
+            }
+        }
+
+        return parser.finish();
+    };
+
+    const auto test = [&](const std::string &json) {
+        INFO("json is " << json);
+        for (const size_t size : {1, 2, 3, 7, 64}) {
+            INFO("part size is " << size);
+            auto expected = parse_fused<Type>(json);
+            auto result = parse_parts(json, size);
+            REQUIRE(result.is_ok() == expected.is_ok());
+            if (expected.is_ok()) {
+                REQUIRE(std::move(result).value() ==
+                        std::move(expected).value());
+                continue;
+            }
+
+            const bool is_json_error = expected.is_json_error();
+            REQUIRE(result.is_json_error() == is_json_error);
+            auto error = std::move(result).error();
+            auto expected_error = std::move(expected).error();
+            REQUIRE(error.path == expected_error.path);
+            if (!is_json_error) {
+                REQUIRE(error.message() == expected_error.message());
+            }
+        }
+    };
+
+    test("{\"a\": [{\"str\": \"x\\\"y\\u00e9\", \"oint\": 12345}, "
+         "{\"str\": \"" + std::string(100, 'z') + "\\\\\", \"oint\": null}],"
+         " \"b\": [], \"c\": [{\"str\": \"\", \"oint\": -1,},],}");
+    test(" {} ");
+    test("");
+    test("{\"a\": [{\"str\": \"x\"}, {\"str\": 1}]}");
+    test("{\"a\": [{\"str\": \"x\", \"oint\": 1.5}]}");
+    test("{\"a\": [{\"str\": \"x\"} {\"str\": \"y\"}]}");
+    test("{\"a\": [{\"str\": \"x\", \"oint\": 1x}]}");
+    test("{\"a\": [{\"str\": \"x\", \"oint\": tru}]}");
+    test("{\"a\": [{\"str\": \"x\\q\"}]}");
+    test("{\"a\": [{\"str\": \"x");
+    test("{\"a\": [{\"str\": 12");
+    test("{\"a\"");
+
+    SECTION("Status is reported") {
+        IncrementalParser<std::vector<int>> parser;
+        REQUIRE(parser.feed("[1, 2") == FeedStatus::NeedMoreInput);
+        REQUIRE(parser.feed("3, ") == FeedStatus::NeedMoreInput);
+        REQUIRE(parser.feed("4] [5]") == FeedStatus::Done);
+        REQUIRE(parser.feed("garbage") == FeedStatus::Done);
+        REQUIRE(parser.finish().value() == std::vector<int>{1, 23, 4});
+
+        IncrementalParser<std::vector<int>> invalid;
+        REQUIRE(invalid.feed("[1, }") == FeedStatus::Error);
+        REQUIRE(invalid.feed("]") == FeedStatus::Error);
+        REQUIRE(invalid.finish().is_json_error());
+
+        IncrementalParser<std::vector<int>> incomplete;
+        REQUIRE(incomplete.feed("[1, 2") == FeedStatus::NeedMoreInput);
+        REQUIRE(incomplete.finish().is_json_error());
+    }
+}
@@ -2,16 +2,24 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory_resource>
 #include <sstream>
 #include <string>
 #include <type_traits>
 
 #include <rapidjson/stringbuffer.h>
 
+#include <ctjson/BufferWriter.hpp>
 #include <ctjson/Json.hpp>
 #include <ctjson/Serializable.hpp>
+#include <ctjson/SegmentWriter.hpp>
 #include <ctjson/SerializationHelper.hpp>
+#include <ctjson/SimpleWriter.hpp>
 
 #include "Utils.hpp"
 
@@ -102,7 +110,8 @@ TEST_CASE("Optional is serialized", "[Serialization]") {
 template <class Container> void test_array(const size_t size) {
     Container arr;
     for (size_t i = 0; i < size; ++i) {
-        if constexpr (std::is_same_v<Container, std::vector<int>>) {
+        if constexpr (std::is_same_v<Container, std::vector<int>> ||
+                      std::is_same_v<Container, std::pmr::vector<int>>) {
             arr.emplace_back(i);
         } else {
             arr.emplace(i);
@@ -137,6 +146,11 @@ TEST_CASE("Arrays are serialized", "[Serialization]") {
     test_array<std::unordered_set<int>>(1);
     test_array<std::unordered_set<int>>(2);
     test_array<std::unordered_set<int>>(42);
+    test_array<std::pmr::vector<int>>(2);
+    test_array<std::pmr::set<int>>(2);
+
+    REQUIRE(dump(std::array<int, 3>{1, 2, 3}) == "[1,2,3]");
+    REQUIRE(dump(std::array<double, 0>{}) == "[]");
 }
 
 template <class Container> void test_dict(const size_t size) {
@@ -176,6 +190,10 @@ TEST_CASE("Dicts are serialized", "[Serialization]") {
     test_dict<std::unordered_map<std::string, int>>(1);
     test_dict<std::unordered_map<std::string, int>>(2);
     test_dict<std::unordered_map<std::string, int>>(42);
+
+    const std::pmr::map<std::pmr::string, std::pmr::string> pmr_dict = {
+        {"a", "b"}, {"c", "d"}};
+    REQUIRE(dump(pmr_dict) == "{\"a\":\"b\",\"c\":\"d\"}");
 }
 
 struct DumpClass {
@@ -280,4 +298,274 @@ TEST_CASE("Nested classes are serialized", "[Serialization]") {
     result.erase(nend, result.end());
 
     REQUIRE(result == json);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Strings are escaped", "[Serialization]") {
+    REQUIRE(dump<std::string>("quote \" backslash \\ slash /") ==
+            "\"quote \\\" backslash \\\\ slash /\"");
+    REQUIRE(dump<std::string>("\b\f\n\r\t") == "\"\\b\\f\\n\\r\\t\"");
+    REQUIRE(dump<std::string>(std::string("\x01\x1f\0", 3)) ==
+            "\"\\u0001\\u001F\\u0000\"");
+    REQUIRE(dump<std::string>("\xd0\xbf\xd1\x80\xd0\xb8") ==
+            "\"\xd0\xbf\xd1\x80\xd0\xb8\"");
+
+    // Escapes grow buffer past initial capacity
+    const std::string newlines(1000, '\n');
+    const auto json = dump(newlines);
+    REQUIRE(json.size() == 2002);
+    REQUIRE(parse<std::string>(json).value() == newlines);
+
+    std::map<std::string, int> dict{{"a\"b", 1}};
+    REQUIRE(dump(dict) == "{\"a\\\"b\":1}");
+}
+
+TEST_CASE("Special numbers are serialized", "[Serialization]") {
+    REQUIRE(dump<double>(1.0) == "1.0");
+    REQUIRE(dump<double>(-0.5) == "-0.5");
+    REQUIRE(dump<float>(0.1f) == "0.1");
+    REQUIRE(dump<double>(1e300) == "1e+300");
+    REQUIRE(dump<double>(std::numeric_limits<double>::quiet_NaN()) == "null");
+    REQUIRE(dump<double>(-std::numeric_limits<double>::infinity()) == "null");
+    REQUIRE(dump<std::int64_t>(std::numeric_limits<std::int64_t>::min()) ==
+            "-9223372036854775808");
+    REQUIRE(dump<std::uint64_t>(std::numeric_limits<std::uint64_t>::max()) ==
+            "18446744073709551615");
+
+    const std::vector<double> values{0.1, 1.0 / 3, 1e-7, 123456789.0};
+    REQUIRE(parse<std::vector<double>>(dump(values)).value() == values);
+}
+
+TEST_CASE("Buffer writer writes separators", "[Serialization]") {
+    BufferWriter writer(1);
+    REQUIRE(!writer.is_complete());
+
+    writer.start_object();
+    writer.key("a");
+    writer.start_array();
+    writer.integer(1);
+    writer.null();
+    writer.start_object();
+    writer.end_object();
+    writer.start_array();
+    writer.end_array();
+    writer.end_array();
+    writer.key("b");
+    writer.boolean(true);
+    REQUIRE(!writer.is_complete());
+    writer.end_object();
+
+    REQUIRE(writer.is_complete());
+    REQUIRE(writer.view() == "{\"a\":[1,null,{},[]],\"b\":true}");
+    REQUIRE(writer.release() == "{\"a\":[1,null,{},[]],\"b\":true}");
+    REQUIRE(writer.view().empty());
+}
+
+struct NamesClass {
+    std::string str;
+    std::optional<int> oint;
+    std::vector<InnerClass> inners;
+
+    constexpr static auto json_names =
+        field_names("str", "oint", "in\"ners\n");
+
+    template <typename Writer>
+    static void json_dump(const NamesClass &object, Writer &writer) {
+        SerializationHelper::dump<json_names>(writer, object.str, object.oint,
+                                              object.inners);
+    }
+};
+
+TEST_CASE("Class with compile-time names is serialized", "[Serialization]") {
+    using Fragments = detail::KeyFragments<NamesClass::json_names>;
+    static_assert(Fragments::get<0>() == "\"str\":");
+    static_assert(Fragments::get<1>() == ",\"oint\":");
+    static_assert(Fragments::get<2>() == ",\"in\\\"ners\\n\":");
+
+    const NamesClass value{
+        .str = "example",
+        .oint = std::nullopt,
+        .inners = {InnerClass{.str = "one", .oint = 1}},
+    };
+    const std::string json = "{\"str\":\"example\",\"oint\":null,"
+                             "\"in\\\"ners\\n\":[{\"str\":\"one\","
+                             "\"oint\":1}]}";
+
+    REQUIRE(dump(value) == json);
+
+    // Writer without raw keys
+    rapidjson::StringBuffer sb;
+    SimpleWriter<rapidjson::StringBuffer> writer(sb);
+    Serializer::dump(value, writer);
+    REQUIRE(sb.GetString() == json);
+}
+
+TEST_CASE("Numbers are formatted", "[Serialization]") {
+    const auto format = [](const auto value) {
+        char buffer[64];
+        return std::string(buffer, detail::write_integer(buffer, value));
+    };
+
+    for (std::uint64_t value = 1; value < 1000000; value = value * 7 + 3) {
+        REQUIRE(format(value) == std::to_string(value));
+        REQUIRE(format(-static_cast<std::int64_t>(value)) ==
+                std::to_string(-static_cast<std::int64_t>(value)));
+    }
+    REQUIRE(format(std::uint8_t{0}) == "0");
+    REQUIRE(format(std::int8_t{-128}) == "-128");
+    REQUIRE(format(std::numeric_limits<std::int32_t>::min()) == "-2147483648");
+    REQUIRE(format(std::uint64_t{10000000000}) == "10000000000");
+
+    BufferWriter writer;
+    writer.set_float_precision(2);
+    writer.start_array();
+    writer.floating(1.0);
+    writer.floating(-2.345);
+    writer.floating(1e20);
+    writer.floating(std::numeric_limits<double>::infinity());
+    writer.set_float_precision(0);
+    writer.floating(2.5f);
+    writer.set_float_precision(std::nullopt);
+    writer.floating(2.5f);
+    writer.end_array();
+    REQUIRE(writer.view() ==
+            "[1.00,-2.35,100000000000000000000.00,null,2.0,2.5]");
+
+    rapidjson::StringBuffer sb;
+    SimpleWriter<rapidjson::StringBuffer> simple(sb);
+    Serializer::dump(std::vector<double>{1.0, 0.1, NAN}, simple);
+    REQUIRE(std::string(sb.GetString()) == "[1.0,0.1,null]");
+}
+
+TEST_CASE("Size of json is measured", "[Serialization]") {
+    const auto check = [](const auto &value) {
+        const auto json = dump(value);
+        REQUIRE(Serializer::measure(value) == json.size());
+
+        const auto exact = dump_exact(value);
+        REQUIRE(exact == json);
+
+        std::vector<char> storage(json.size());
+        REQUIRE(dump_to(value, storage.data(), storage.size()) == json.size());
+        REQUIRE(std::string_view(storage.data(), storage.size()) == json);
+        if (!json.empty()) {
+            REQUIRE(!dump_to(value, storage.data(), json.size() - 1));
+        }
+    };
+
+    check(0);
+    check(-1234567890123ll);
+    check(std::numeric_limits<std::uint64_t>::max());
+    check(std::vector<double>{1.0, -0.25, 1e-300, NAN});
+    check(std::vector<std::optional<bool>>{true, false, std::nullopt});
+    check(std::map<std::string, std::string>{{"k\"\x01", "v\n\\"},
+                                             {"", ""}});
+    check(std::vector<std::vector<int>>{{}, {1, 22}, {333}});
+    check(NamesClass{
+        .str = "example",
+        .oint = 42,
+        .inners = {InnerClass{.str = "one", .oint = std::nullopt}},
+    });
+    check(OuterClass{.boolean = true, .str = "s", .inners = {}});
+
+    // Allocated once with exact size
+    const std::vector<int> large(1000, 7);
+    REQUIRE(Serializer::measure(large) == dump(large).size());
+    REQUIRE(dump_exact(large).capacity() >= dump(large).size());
+
+    // Writer is movable, also when its data is stored inline in std::string
+    BufferWriter writer(4);
+    Serializer::dump(std::vector<int>{1}, writer);
+    BufferWriter moved(std::move(writer));
+    REQUIRE(moved.view() == "[1]");
+    REQUIRE(moved.release() == "[1]");
+}
+
+TEST_CASE("Large strings are referenced by segment writer", "[Serialization]") {
+    const std::string blob(1000, 'x');
+    const std::string escaped = std::string(300, 'a') + "\n\"" +
+                                std::string(10, 'b') + "\t" +
+                                std::string(500, 'c');
+    const std::map<std::string, std::string> value{
+        {"blob", blob}, {"escaped", escaped}, {"short", "s\n"}};
+
+    SegmentWriter writer(256, 16);
+    Serializer::dump(value, writer);
+    REQUIRE(writer.is_complete());
+
+    const auto segments = writer.segments();
+    std::string json;
+    std::vector<const void *> bases;
+    for (const auto &segment : segments) {
+        json.append(static_cast<const char *>(segment.iov_base),
+                    segment.iov_len);
+        bases.push_back(segment.iov_base);
+    }
+
+    REQUIRE(json == dump(value));
+    REQUIRE(writer.size() == json.size());
+
+    // Blob and both long runs of escaped string are not copied
+    const auto is_referenced = [&bases](const char *data) {
+        return std::find(bases.begin(), bases.end(), data) != bases.end();
+    };
+    REQUIRE(is_referenced(value.at("blob").data()));
+    REQUIRE(is_referenced(value.at("escaped").data()));
+    REQUIRE(is_referenced(value.at("escaped").data() + 313));
+    REQUIRE(segments.size() == 7);
+}
+
+TEST_CASE("Strings are escaped with SIMD scan", "[Serialization]") {
+    // Special bytes at every position of 16 and 32 byte blocks
+    for (size_t size : {size_t{0}, size_t{15}, size_t{16}, size_t{31},
+                        size_t{33}, size_t{100}}) {
+        for (size_t pos = 0; pos < size; ++pos) {
+            for (const char special : {'"', '\\', '\x01', '\x1f', '\x80'}) {
+                std::string value(size, 'a');
+                value[pos] = special;
+                REQUIRE(detail::find_special(value.data(), value.size(),
+                                             true) == pos);
+                REQUIRE(detail::find_special(value.data(), value.size(),
+                                             false) ==
+                        (special == '\x80' ? size : pos));
+            }
+        }
+    }
+
+    // Escapes match scalar table
+    std::string all;
+    for (int c = 0; c < 128; ++c) {
+        all += static_cast<char>(c);
+    }
+    const auto json = dump(all + all);
+    REQUIRE(json.size() == Serializer::measure(all + all));
+    REQUIRE(parse<std::string>(json).value() == all + all);
+}
+
+TEST_CASE("UTF-8 is validated by writer", "[Serialization]") {
+    const auto write = [](const std::string &value) {
+        BufferWriter writer;
+        writer.set_validate_utf8(true);
+        writer.string(value);
+        return writer.release();
+    };
+
+    const std::string valid = "a\xd0\xbf\xe2\x82\xac\xf0\x9f\x98\x80z";
+    REQUIRE(write(valid) == "\"" + valid + "\"");
+    REQUIRE(write(std::string(40, 'x') + valid) ==
+            "\"" + std::string(40, 'x') + valid + "\"");
+
+    const std::string replacement = "\xef\xbf\xbd";
+    // Lone continuation, truncated sequence, overlong, surrogate
+    REQUIRE(write("\x80") == "\"" + replacement + "\"");
+    REQUIRE(write("a\xe2\x82") ==
+            "\"a" + replacement + replacement + "\"");
+    REQUIRE(write("\xc0\xaf") == "\"" + replacement + replacement + "\"");
+    REQUIRE(write("\xed\xa0\x80\n") ==
+            "\"" + replacement + replacement + replacement + "\\n\"");
+    REQUIRE(write("\xf4\x90\x80\x80") ==
+            "\"" + replacement + replacement + replacement + replacement +
+                "\"");
+
+    // Not validated by default
+    REQUIRE(dump<std::string>("\x80") == "\"\x80\"");
+}